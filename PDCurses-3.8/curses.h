@@ -351,6 +351,8 @@ typedef struct
 #endif
     short line_color;     /* color of line attributes - default -1 */
     attr_t termattrs;     /* attribute capabilities */
+    unsigned long lines_sent;  /* lines and cells doupdate() has handed */
+    unsigned long cells_sent;  /* to PDC_transform_line() so far */
 } SCREEN;
 
 /*----------------------------------------------------------------------
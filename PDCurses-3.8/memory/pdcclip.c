@@ -0,0 +1,121 @@
+/* PDCurses */
+
+#include "pdcmem.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/*man-start**************************************************************
+
+clipboard
+---------
+
+### Synopsis
+
+    int PDC_getclipboard(char **contents, long *length);
+    int PDC_setclipboard(const char *contents, long length);
+    int PDC_freeclipboard(char *contents);
+    int PDC_clearclipboard(void);
+
+### Description
+
+   PDC_getclipboard() gets the textual contents of the system's
+   clipboard. This function returns the contents of the clipboard
+   in the contents argument. It is the responsibilitiy of the
+   caller to free the memory returned, via PDC_freeclipboard().
+   The length of the clipboard contents is returned in the length
+   argument.
+
+   PDC_setclipboard copies the supplied text into the system's
+   clipboard, emptying the clipboard prior to the copy.
+
+   PDC_clearclipboard() clears the internal clipboard.
+
+   The memory port has no system clipboard, it keeps its own.
+
+### Return Values
+
+   indicator of success/failure of call.
+   PDC_CLIP_SUCCESS        the call was successful
+   PDC_CLIP_MEMORY_ERROR   unable to allocate sufficient memory for
+                           the clipboard contents
+   PDC_CLIP_EMPTY          the clipboard contains no text
+   PDC_CLIP_ACCESS_ERROR   no clipboard support
+
+### Portability
+                             X/Open    BSD    SYS V
+    PDC_getclipboard            -       -       -
+    PDC_setclipboard            -       -       -
+    PDC_freeclipboard           -       -       -
+    PDC_clearclipboard          -       -       -
+
+**man-end****************************************************************/
+
+/* global clipboard contents, should be NULL if none set */
+
+static char *pdc_mem_clipboard = NULL;
+
+int PDC_getclipboard(char **contents, long *length)
+{
+    int len;
+
+    PDC_LOG(("PDC_getclipboard() - called\n"));
+
+    if (!pdc_mem_clipboard)
+        return PDC_CLIP_EMPTY;
+
+    len = strlen(pdc_mem_clipboard);
+    *contents = malloc(len + 1);
+    if (!*contents)
+        return PDC_CLIP_MEMORY_ERROR;
+
+    strcpy(*contents, pdc_mem_clipboard);
+    *length = len;
+
+    return PDC_CLIP_SUCCESS;
+}
+
+int PDC_setclipboard(const char *contents, long length)
+{
+    PDC_LOG(("PDC_setclipboard() - called\n"));
+
+    if (pdc_mem_clipboard)
+    {
+        free(pdc_mem_clipboard);
+        pdc_mem_clipboard = NULL;
+    }
+
+    if (contents)
+    {
+        pdc_mem_clipboard = malloc(length + 1);
+        if (!pdc_mem_clipboard)
+            return PDC_CLIP_MEMORY_ERROR;
+
+        memcpy(pdc_mem_clipboard, contents, length);
+        pdc_mem_clipboard[length] = '\0';
+    }
+
+    return PDC_CLIP_SUCCESS;
+}
+
+int PDC_freeclipboard(char *contents)
+{
+    PDC_LOG(("PDC_freeclipboard() - called\n"));
+
+    free(contents);
+
+    return PDC_CLIP_SUCCESS;
+}
+
+int PDC_clearclipboard(void)
+{
+    PDC_LOG(("PDC_clearclipboard() - called\n"));
+
+    if (pdc_mem_clipboard)
+    {
+        free(pdc_mem_clipboard);
+        pdc_mem_clipboard = NULL;
+    }
+
+    return PDC_CLIP_SUCCESS;
+}
@@ -0,0 +1,105 @@
+/* PDCurses */
+
+#include "pdcmem.h"
+
+#include <string.h>
+
+#ifdef PDC_WIDE
+# include "../common/acsgr.h"
+#else
+# include "../common/acs437.h"
+#endif
+
+chtype *pdc_mem_screen = NULL;
+int pdc_mem_lines = 0, pdc_mem_cols = 0;
+
+/* the cursor is only a position here, there is nothing to draw it on */
+
+void PDC_gotoyx(int row, int col)
+{
+    PDC_LOG(("PDC_gotoyx() - called: row %d col %d from row %d col %d\n",
+             row, col, SP->cursrow, SP->curscol));
+}
+
+/* update the given physical line to look like the corresponding line in
+   curscr -- the cells go into the framebuffer as they are, attributes
+   and all */
+
+void PDC_transform_line(int lineno, int x, int len, const chtype *srcp)
+{
+    PDC_LOG(("PDC_transform_line() - called: lineno=%d\n", lineno));
+
+    if (lineno < 0 || lineno >= pdc_mem_lines || x < 0 || x >= pdc_mem_cols)
+        return;
+
+    if (x + len > pdc_mem_cols)
+        len = pdc_mem_cols - x;
+
+    memcpy(pdc_mem_screen + (long)lineno * pdc_mem_cols + x, srcp,
+           len * sizeof(chtype));
+}
+
+/* move rows top to bottom of the framebuffer up n rows, or down if n is
+   negative; the rows scrolled in keep what they had, as on a display
+   that doesn't clear them */
+
+bool PDC_scroll(int top, int bottom, int n)
+{
+    int count;
+
+    PDC_LOG(("PDC_scroll() - called: top %d bottom %d n %d\n",
+             top, bottom, n));
+
+    if (top < 0 || bottom >= pdc_mem_lines)
+        return FALSE;
+
+    count = bottom - top + 1 - (n > 0 ? n : -n);
+
+    if (n > 0)
+        memmove(pdc_mem_screen + (long)top * pdc_mem_cols,
+                pdc_mem_screen + (long)(top + n) * pdc_mem_cols,
+                (long)count * pdc_mem_cols * sizeof(chtype));
+    else
+        memmove(pdc_mem_screen + (long)(top - n) * pdc_mem_cols,
+                pdc_mem_screen + (long)top * pdc_mem_cols,
+                (long)count * pdc_mem_cols * sizeof(chtype));
+
+    return TRUE;
+}
+
+/* write the text of the framebuffer to a file, one line per row,
+   attributes dropped */
+
+int PDC_mem_dump(const char *filename)
+{
+    FILE *fp;
+    int i, j;
+
+    if (!pdc_mem_screen || !filename)
+        return ERR;
+
+    fp = fopen(filename, "w");
+    if (!fp)
+        return ERR;
+
+    for (i = 0; i < pdc_mem_lines; i++)
+    {
+        const chtype *row = pdc_mem_screen + (long)i * pdc_mem_cols;
+
+        for (j = 0; j < pdc_mem_cols; j++)
+        {
+            chtype ch = row[j] & A_CHARTEXT;
+
+            if (row[j] & A_ALTCHARSET && !(ch & 0xff80))
+                ch = acs_map[ch & 0x7f] & A_CHARTEXT;
+
+            fputc(ch >= ' ' && ch < 0x7f ? (int)ch : '?', fp);
+        }
+
+        fputc('\n', fp);
+    }
+
+    fclose(fp);
+
+    return OK;
+}
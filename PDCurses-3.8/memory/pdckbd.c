@@ -0,0 +1,135 @@
+/* PDCurses */
+
+#include "pdcmem.h"
+
+/*man-start**************************************************************
+
+pdckbd
+------
+
+### Synopsis
+
+    unsigned long PDC_get_input_fd(void);
+
+    int PDC_mem_push_key(int key);
+    int PDC_mem_push_keys(const char *keys);
+
+### Description
+
+   PDC_get_input_fd() returns the file descriptor that PDCurses
+   reads its input from. It can be used for select(). The memory
+   port reads no file, it returns 0.
+
+   PDC_mem_push_key() queues one key (a character or a KEY_ code)
+   for getch() to return, as if it had been typed. PDC_mem_push_keys()
+   queues every character of a string. Keys queued before initscr()
+   stay queued. When pdc_mem_key_delay is set (or PDC_KEY_DELAY in
+   the environment, in milliseconds), each key only becomes readable
+   that long after the previous one was read, so a script can play
+   out over time instead of all at once.
+
+### Return Values
+
+   PDC_mem_push_key() and PDC_mem_push_keys() return OK, or ERR when
+   the queue is full.
+
+### Portability
+                             X/Open    BSD    SYS V
+    PDC_get_input_fd            -       -       -
+    PDC_mem_push_key            -       -       -
+    PDC_mem_push_keys           -       -       -
+
+**man-end****************************************************************/
+
+unsigned long pdc_key_modifiers = 0L;
+
+int pdc_mem_key_delay = 0;
+
+static int keys[PDC_MEM_MAXKEYS];
+static int key_head = 0, key_count = 0;
+static unsigned long last_key = 0;
+
+unsigned long PDC_get_input_fd(void)
+{
+    PDC_LOG(("PDC_get_input_fd() - called\n"));
+
+    return 0L;
+}
+
+void PDC_set_keyboard_binary(bool on)
+{
+    PDC_LOG(("PDC_set_keyboard_binary() - called\n"));
+}
+
+int PDC_mem_push_key(int key)
+{
+    if (key_count == PDC_MEM_MAXKEYS)
+        return ERR;
+
+    keys[(key_head + key_count) % PDC_MEM_MAXKEYS] = key;
+    key_count++;
+
+    return OK;
+}
+
+int PDC_mem_push_keys(const char *str)
+{
+    while (*str)
+        if (PDC_mem_push_key((unsigned char)*str++) == ERR)
+            return ERR;
+
+    return OK;
+}
+
+/* check if a key is waiting, and due if the keys are paced */
+
+bool PDC_check_key(void)
+{
+    if (!key_count)
+        return FALSE;
+
+    return pdc_mem_key_delay <= 0 ||
+           PDC_mem_ms() - last_key >= (unsigned long)pdc_mem_key_delay;
+}
+
+/* return the next queued key */
+
+int PDC_get_key(void)
+{
+    int key;
+
+    if (!key_count)
+        return -1;
+
+    key = keys[key_head];
+    key_head = (key_head + 1) % PDC_MEM_MAXKEYS;
+    key_count--;
+    last_key = PDC_mem_ms();
+
+    SP->key_code = (key >= KEY_MIN);
+
+    if (key == KEY_RESIZE)
+        SP->resized = TRUE;
+
+    return key;
+}
+
+/* discard any pending keyboard or mouse input -- this is the core
+   routine for flushinp() */
+
+void PDC_flushinp(void)
+{
+    PDC_LOG(("PDC_flushinp() - called\n"));
+
+    key_head = key_count = 0;
+}
+
+int PDC_mouse_set(void)
+{
+    return OK;
+}
+
+int PDC_modifiers_set(void)
+{
+    return OK;
+}
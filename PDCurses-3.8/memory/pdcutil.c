@@ -0,0 +1,56 @@
+/* PDCurses */
+
+#include "pdcmem.h"
+
+#ifdef _WIN32
+# define WIN32_LEAN_AND_MEAN
+# include <windows.h>
+#else
+# include <time.h>
+# include <sys/time.h>
+#endif
+
+void PDC_beep(void)
+{
+    PDC_LOG(("PDC_beep() - called\n"));
+}
+
+void PDC_napms(int ms)
+{
+    PDC_LOG(("PDC_napms() - called: ms=%d\n", ms));
+
+    if (ms <= 0)
+        return;
+
+#ifdef _WIN32
+    Sleep(ms);
+#else
+    {
+        struct timespec wait;
+
+        wait.tv_sec = ms / 1000;
+        wait.tv_nsec = (ms % 1000) * 1000000L;
+        nanosleep(&wait, NULL);
+    }
+#endif
+}
+
+/* milliseconds from an arbitrary start, for pacing scripted keys */
+
+unsigned long PDC_mem_ms(void)
+{
+#ifdef _WIN32
+    return (unsigned long)GetTickCount();
+#else
+    struct timeval now;
+
+    gettimeofday(&now, NULL);
+
+    return (unsigned long)now.tv_sec * 1000UL + now.tv_usec / 1000;
+#endif
+}
+
+const char *PDC_sysname(void)
+{
+    return "Memory";
+}
@@ -64,6 +64,17 @@ void _new_packet(attr_t attr, int lineno, int x, int len, const chtype *srcp)
                      (USHORT)x, (PBYTE)&mapped_attr, 0);
 }
 
+/* there's no scrolling of the screen here; doupdate() sends the lines
+   instead */
+
+bool PDC_scroll(int top, int bottom, int n)
+{
+    PDC_LOG(("PDC_scroll() - called: top %d bottom %d n %d\n",
+             top, bottom, n));
+
+    return FALSE;
+}
+
 /* update the given physical line to look like the corresponding line in
    curscr */
 
@@ -64,33 +64,116 @@ addstr
 
 **man-end****************************************************************/
 
+/* the character at str[i] into *ch, returning its length in bytes, or 0
+   at the end of the string, after n bytes, or where it can't be read */
+
+static int _next_char(const char *str, int i, int n, chtype *ch)
+{
+    if (!str[i] || (n >= 0 && i >= n))
+        return 0;
+#ifdef PDC_WIDE
+    {
+        wchar_t wch;
+        int retval = PDC_mbtowc(&wch, str + i, n >= 0 ? n - i : 6);
+
+        if (retval <= 0)
+            return 0;
+
+        *ch = wch;
+        return retval;
+    }
+#else
+    *ch = (unsigned char)str[i];
+    return 1;
+#endif
+}
+
 int waddnstr(WINDOW *win, const char *str, int n)
 {
-    int i = 0;
+    chtype ch, attr, blank, *line;
+    int i = 0, len, x, first, last;
 
     PDC_LOG(("waddnstr() - called: string=\"%s\" n %d \n", str, n));
 
     if (!win || !str)
         return ERR;
 
-    while (str[i] && (i < n || n < 0))
-    {
-#ifdef PDC_WIDE
-        wchar_t wch;
-        int retval = PDC_mbtowc(&wch, str + i, n >= 0 ? n - i : 6);
+    /* the attributes waddch() would give any plain character */
 
-        if (retval <= 0)
+    attr = win->_attrs;
+
+    if (!(attr & A_COLOR))
+        attr |= win->_bkgd & A_ATTRIBUTES;
+    else
+        attr |= win->_bkgd & (A_ATTRIBUTES ^ A_COLOR);
+
+    blank = (win->_bkgd & A_CHARTEXT) | attr;
+
+    for (;;)
+    {
+        /* a run of printable characters that stops short of the last
+           column goes straight into the line, with its change range
+           set once; anything else, and the wrap, is left to waddch() */
+
+        x = win->_curx;
+
+        if (win->_cury >= 0 && win->_cury < win->_maxy && x >= 0)
+        {
+            line = win->_y[win->_cury];
+            first = last = -1;
+
+            while (x < win->_maxx - 1 &&
+                   (len = _next_char(str, i, n, &ch)) != 0 &&
+                   ch >= ' ' && ch != 0x7f && !(ch & A_ATTRIBUTES))
+            {
+                i += len;
+                ch = (ch == ' ') ? blank : (ch | attr);
+
+                if (line[x] != ch)
+                {
+                    if (first < 0)
+                        first = x;
+
+                    last = x;
+                    line[x] = ch;
+                }
+
+                x++;
+            }
+
+            if (first >= 0)
+            {
+                int y = win->_cury;
+
+                if (win->_firstch[y] == _NO_CHANGE ||
+                    first < win->_firstch[y])
+                    win->_firstch[y] = first;
+
+                if (last > win->_lastch[y])
+                    win->_lastch[y] = last;
+            }
+
+            if (x != win->_curx)
+            {
+                win->_curx = x;
+
+                if (win->_immed)
+                    wrefresh(win);
+                if (win->_sync)
+                    wsyncup(win);
+            }
+        }
+
+        len = _next_char(str, i, n, &ch);
+
+        if (!len)
             return OK;
 
-        i += retval;
-#else
-        chtype wch = (unsigned char)(str[i++]);
-#endif
-        if (waddch(win, wch) == ERR)
+        i += len;
+
+        if (waddch(win, ch) == ERR)
             return ERR;
     }
-
-    return OK;
 }
 
 int addstr(const char *str)
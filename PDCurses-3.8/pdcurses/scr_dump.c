@@ -58,7 +58,6 @@ scr_dump
 
 **man-end****************************************************************/
 
-#include <stdlib.h>
 #include <string.h>
 
 #define DUMPVER 1   /* Should be updated whenever the WINDOW struct is
@@ -93,62 +92,36 @@ int putwin(WINDOW *win, FILE *filep)
 
 WINDOW *getwin(FILE *filep)
 {
-    WINDOW *win;
+    WINDOW *win, saved;
     char marker[4];
     int i, nlines, ncols;
 
     PDC_LOG(("getwin() - called\n"));
 
-    win = malloc(sizeof(WINDOW));
-    if (!win)
-        return (WINDOW *)NULL;
-
     /* check for the marker, and load the WINDOW struct */
 
     if (!filep || !fread(marker, 4, 1, filep) || strncmp(marker, "PDC", 3)
-        || marker[3] != DUMPVER || !fread(win, sizeof(WINDOW), 1, filep))
-    {
-        free(win);
+        || marker[3] != DUMPVER || !fread(&saved, sizeof(WINDOW), 1, filep))
         return (WINDOW *)NULL;
-    }
 
-    nlines = win->_maxy;
-    ncols = win->_maxx;
+    nlines = saved._maxy;
+    ncols = saved._maxx;
 
-    /* allocate the line pointer array */
+    /* allocate the arrays and the lines, then take everything else
+       from the file */
 
-    win->_y = malloc(nlines * sizeof(chtype *));
-    if (!win->_y)
-    {
-        free(win);
-        return (WINDOW *)NULL;
-    }
+    win = PDC_makenew(nlines, ncols, saved._begy, saved._begx);
+    if (win)
+        win = PDC_makelines(win);
 
-    /* allocate the minchng and maxchng arrays */
-
-    win->_firstch = malloc(nlines * sizeof(int));
-    if (!win->_firstch)
-    {
-        free(win->_y);
-        free(win);
-        return (WINDOW *)NULL;
-    }
-
-    win->_lastch = malloc(nlines * sizeof(int));
-    if (!win->_lastch)
-    {
-        free(win->_firstch);
-        free(win->_y);
-        free(win);
-        return (WINDOW *)NULL;
-    }
-
-    /* allocate the lines */
-
-    win = PDC_makelines(win);
     if (!win)
         return (WINDOW *)NULL;
 
+    saved._y = win->_y;
+    saved._firstch = win->_firstch;
+    saved._lastch = win->_lastch;
+    *win = saved;
+
     /* read them */
 
     for (i = 0; i < nlines; i++)
@@ -90,9 +90,12 @@ window
    PDC_makenew() allocates all data for a new WINDOW * except the
    actual lines themselves. If it's unable to allocate memory for
    the window structure, it will free all allocated memory and
-   return a NULL pointer.
+   return a NULL pointer. The line pointers and the change arrays
+   share one block; WINDOW structs themselves are recycled by
+   delwin().
 
-   PDC_makelines() allocates the memory for the lines.
+   PDC_makelines() allocates the memory for the lines, all of them
+   in one block of nlines * ncols cells.
 
    PDC_sync() handles wrefresh() and wsyncup() calls when a window
    is changed.
@@ -135,6 +138,42 @@ window
 **man-end****************************************************************/
 
 #include <stdlib.h>
+#include <string.h>
+
+/* The block behind _y holds the nlines line pointers, then the pointer
+   to the window's own cells (NULL for subwindows, which use their
+   parent's), then the minchng and maxchng arrays. Lines get swapped
+   around by scrolling, so the cells are found through that extra
+   pointer, not through _y[0]. */
+
+#define _CELLS(win) ((win)->_y[(win)->_maxy])
+
+/* delwin() keeps up to _POOLED WINDOW structs for the next windows to
+   be made, instead of handing them back to free() */
+
+#define _POOLED 16
+
+static WINDOW *win_pool[_POOLED];
+static int win_pooled = 0;
+
+static WINDOW *_new_win(void)
+{
+    WINDOW *win = win_pooled ? win_pool[--win_pooled] :
+                               malloc(sizeof(WINDOW));
+
+    if (win)
+        memset(win, 0, sizeof(WINDOW));
+
+    return win;
+}
+
+static void _free_win(WINDOW *win)
+{
+    if (win_pooled < _POOLED)
+        win_pool[win_pooled++] = win;
+    else
+        free(win);
+}
 
 WINDOW *PDC_makenew(int nlines, int ncols, int begy, int begx)
 {
@@ -145,37 +184,24 @@ WINDOW *PDC_makenew(int nlines, int ncols, int begy, int begx)
 
     /* allocate the window structure itself */
 
-    win = calloc(1, sizeof(WINDOW));
+    win = _new_win();
     if (!win)
         return win;
 
-    /* allocate the line pointer array */
+    /* allocate the line pointer array and the minchng and maxchng
+       arrays */
 
-    win->_y = malloc(nlines * sizeof(chtype *));
+    win->_y = malloc((nlines + 1) * sizeof(chtype *) +
+                     nlines * 2 * sizeof(int));
     if (!win->_y)
     {
-        free(win);
+        _free_win(win);
         return (WINDOW *)NULL;
     }
 
-    /* allocate the minchng and maxchng arrays */
-
-    win->_firstch = malloc(nlines * sizeof(int));
-    if (!win->_firstch)
-    {
-        free(win->_y);
-        free(win);
-        return (WINDOW *)NULL;
-    }
-
-    win->_lastch = malloc(nlines * sizeof(int));
-    if (!win->_lastch)
-    {
-        free(win->_firstch);
-        free(win->_y);
-        free(win);
-        return (WINDOW *)NULL;
-    }
+    win->_y[nlines] = NULL;
+    win->_firstch = (int *)(win->_y + nlines + 1);
+    win->_lastch = win->_firstch + nlines;
 
     /* initialize window variables */
 
@@ -197,7 +223,8 @@ WINDOW *PDC_makenew(int nlines, int ncols, int begy, int begx)
 
 WINDOW *PDC_makelines(WINDOW *win)
 {
-    int i, j, nlines, ncols;
+    int i, nlines, ncols;
+    chtype *cells;
 
     PDC_LOG(("PDC_makelines() - called\n"));
 
@@ -207,25 +234,22 @@ WINDOW *PDC_makelines(WINDOW *win)
     nlines = win->_maxy;
     ncols = win->_maxx;
 
-    for (i = 0; i < nlines; i++)
+    cells = malloc((size_t)nlines * ncols * sizeof(chtype) + 1);
+    if (!cells)
     {
-        win->_y[i] = malloc(ncols * sizeof(chtype));
-        if (!win->_y[i])
-        {
-            /* if error, free all the data */
-
-            for (j = 0; j < i; j++)
-                free(win->_y[j]);
+        /* if error, free all the data */
 
-            free(win->_firstch);
-            free(win->_lastch);
-            free(win->_y);
-            free(win);
+        free(win->_y);
+        _free_win(win);
 
-            return (WINDOW *)NULL;
-        }
+        return (WINDOW *)NULL;
     }
 
+    for (i = 0; i < nlines; i++)
+        win->_y[i] = cells + (size_t)i * ncols;
+
+    _CELLS(win) = cells;
+
     return win;
 }
 
@@ -266,8 +290,6 @@ WINDOW *newwin(int nlines, int ncols, int begy, int begx)
 
 int delwin(WINDOW *win)
 {
-    int i;
-
     PDC_LOG(("delwin() - called\n"));
 
     if (!win)
@@ -276,14 +298,10 @@ int delwin(WINDOW *win)
     /* subwindows use parents' lines */
 
     if (!(win->_flags & (_SUBWIN|_SUBPAD)))
-        for (i = 0; i < win->_maxy && win->_y[i]; i++)
-            if (win->_y[i])
-                free(win->_y[i]);
+        free(_CELLS(win));
 
-    free(win->_firstch);
-    free(win->_lastch);
     free(win->_y);
-    free(win);
+    _free_win(win);
 
     return OK;
 }
@@ -386,7 +404,6 @@ int mvderwin(WINDOW *win, int pary, int parx)
 WINDOW *dupwin(WINDOW *win)
 {
     WINDOW *new;
-    chtype *ptr, *ptr1;
     int nlines, ncols, begy, begx, i;
 
     if (!win)
@@ -408,9 +425,7 @@ WINDOW *dupwin(WINDOW *win)
 
     for (i = 0; i < nlines; i++)
     {
-        for (ptr = new->_y[i], ptr1 = win->_y[i];
-             ptr < new->_y[i] + ncols; ptr++, ptr1++)
-            *ptr = *ptr1;
+        memcpy(new->_y[i], win->_y[i], ncols * sizeof(chtype));
 
         new->_firstch[i] = 0;
         new->_lastch[i] = ncols - 1;
@@ -444,7 +459,7 @@ WINDOW *dupwin(WINDOW *win)
 WINDOW *resize_window(WINDOW *win, int nlines, int ncols)
 {
     WINDOW *new;
-    int i, save_cury, save_curx, new_begy, new_begx;
+    int save_cury, save_curx, new_begy, new_begx;
 
     PDC_LOG(("resize_window() - called: nlines %d ncols %d\n",
              nlines, ncols));
@@ -496,9 +511,7 @@ WINDOW *resize_window(WINDOW *win, int nlines, int ncols)
         copywin(win, new, 0, 0, 0, 0, min(win->_maxy, new->_maxy) - 1,
                 min(win->_maxx, new->_maxx) - 1, FALSE);
 
-        for (i = 0; i < win->_maxy && win->_y[i]; i++)
-            if (win->_y[i])
-                free(win->_y[i]);
+        free(_CELLS(win));
     }
 
     new->_flags = win->_flags;
@@ -520,12 +533,10 @@ WINDOW *resize_window(WINDOW *win, int nlines, int ncols)
     new->_curx = save_curx;
     new->_cury = save_cury;
 
-    free(win->_firstch);
-    free(win->_lastch);
     free(win->_y);
 
     *win = *new;
-    free(new);
+    _free_win(new);
 
     return win;
 }
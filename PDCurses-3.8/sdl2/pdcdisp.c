@@ -481,6 +481,59 @@ void _new_packet(attr_t attr, int lineno, int x, int len, const chtype *srcp)
     }
 }
 
+/* move the text on lines top to bottom up n lines, or down if n is
+   negative, by copying the pixels; the lines scrolled in are left as
+   they were */
+
+bool PDC_scroll(int top, int bottom, int n)
+{
+    SDL_Rect dest;
+    Uint8 *pixels;
+    long pitch;
+    int from, to, height;
+
+    PDC_LOG(("PDC_scroll() - called: top %d bottom %d n %d\n",
+             top, bottom, n));
+
+    /* a background picture doesn't scroll along with the text */
+
+    if (pdc_tileback)
+        return FALSE;
+
+    /* take the cursor off first, or it would be moved too */
+
+    if (SP->visibility && SP->cursrow >= top && SP->cursrow <= bottom)
+        PDC_transform_line(SP->cursrow, SP->curscol, 1,
+                           pdc_lastscr->_y[SP->cursrow] + SP->curscol);
+
+    height = (bottom - top + 1 - (n > 0 ? n : -n)) * pdc_fheight;
+    from = (n > 0 ? top + n : top) * pdc_fheight + pdc_yoffset;
+    to = (n > 0 ? top : top - n) * pdc_fheight + pdc_yoffset;
+
+    if (SDL_MUSTLOCK(pdc_screen) && SDL_LockSurface(pdc_screen) < 0)
+        return FALSE;
+
+    pitch = pdc_screen->pitch;
+    pixels = (Uint8 *)pdc_screen->pixels;
+
+    memmove(pixels + to * pitch, pixels + from * pitch, height * pitch);
+
+    if (SDL_MUSTLOCK(pdc_screen))
+        SDL_UnlockSurface(pdc_screen);
+
+    if (rectcount == MAXRECT)
+        PDC_update_rects();
+
+    dest.x = pdc_xoffset;
+    dest.y = pdc_fheight * top + pdc_yoffset;
+    dest.w = pdc_fwidth * SP->cols;
+    dest.h = pdc_fheight * (bottom - top + 1);
+
+    uprect[rectcount++] = dest;
+
+    return TRUE;
+}
+
 /* update the given physical line to look like the corresponding line in
    curscr */
 
@@ -100,6 +100,18 @@ void PDC_gotoyx(int row, int col)
     PDC_display_cursor(SP->cursrow, SP->curscol, row, col, SP->visibility);
 }
 
+/* the display is drawn by the other process, which has no request to
+   copy an area of the window with, so doupdate() sends the lines
+   instead */
+
+bool PDC_scroll(int top, int bottom, int n)
+{
+    PDC_LOG(("PDC_scroll() - called: top %d bottom %d n %d\n",
+             top, bottom, n));
+
+    return FALSE;
+}
+
 /* update the given physical line to look like the corresponding line in
    curscr */
 
@@ -77,6 +77,7 @@ void    PDC_save_screen_mode(int);
 void    PDC_scr_close(void);
 void    PDC_scr_free(void);
 int     PDC_scr_open(int, char **);
+bool    PDC_scroll(int, int, int);
 void    PDC_set_keyboard_binary(bool);
 void    PDC_transform_line(int, int, int, const chtype *);
 const char *PDC_sysname(void);
@@ -87,6 +88,8 @@ void    PDC_init_atrtab(void);
 WINDOW *PDC_makelines(WINDOW *);
 WINDOW *PDC_makenew(int, int, int, int);
 int     PDC_mouse_in_slk(int, int);
+void    PDC_rotate_lines(chtype **, int, int);
+void    PDC_scrolled(WINDOW *, int);
 void    PDC_slk_free(void);
 void    PDC_slk_initialize(void);
 void    PDC_sync(WINDOW *);
@@ -0,0 +1,394 @@
+/* A regression check and a refresh benchmark for the memory port. It
+   draws, refreshes and types into PDCurses with no display at all, and
+   checks what came out in the framebuffer. Exits with 1 on a failure.
+
+   memtest [frames]
+*/
+
+#include <curses.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* You could #include pdcmem.h, or just add the relevant declarations
+   here: */
+
+PDCEX chtype *pdc_mem_screen;
+PDCEX int pdc_mem_lines, pdc_mem_cols;
+PDCEX int PDC_mem_push_key(int key);
+PDCEX int PDC_mem_push_keys(const char *keys);
+
+static int checks = 0, failures = 0;
+
+static void check(int ok, const char *what)
+{
+    checks++;
+
+    if (!ok)
+    {
+        failures++;
+        fprintf(stderr, "memtest: %s failed\n", what);
+    }
+}
+
+static int screen_has(int y, int x, const char *text)
+{
+    const chtype *cell = pdc_mem_screen + y * pdc_mem_cols + x;
+
+    while (*text)
+        if ((*cell++ & A_CHARTEXT) != (chtype)(unsigned char)*text++)
+            return FALSE;
+
+    return TRUE;
+}
+
+static double seconds(void)
+{
+    return (double)clock() / CLOCKS_PER_SEC;
+}
+
+static void bench(const char *name, int frames, int changed_rows)
+{
+    unsigned long lines = SP->lines_sent, cells = SP->cells_sent;
+    double start = seconds(), used;
+    int f, y;
+
+    for (f = 0; f < frames; f++)
+    {
+        for (y = 0; y < changed_rows; y++)
+            mvprintw(y, 0, "%*d", COLS - 1, f * LINES + y);
+
+        refresh();
+    }
+
+    used = seconds() - start;
+
+    printf("%-12s %8.2f us/frame %8.1f lines %8.1f cells per frame\n",
+           name, used * 1e6 / frames,
+           (double)(SP->lines_sent - lines) / frames,
+           (double)(SP->cells_sent - cells) / frames);
+}
+
+/* refresh alone: two prepared screens are swapped in every frame, so
+   only the change detection and the copying are timed */
+
+static void churn(int lines, int cols, int frames, int step)
+{
+    WINDOW *win[2];
+    unsigned long sent = SP->cells_sent;
+    double start, used;
+    char name[40];
+    int f, y, x;
+
+    if (resize_term(lines, cols) == ERR)
+        return;
+
+    win[0] = newwin(LINES, COLS, 0, 0);
+    win[1] = newwin(LINES, COLS, 0, 0);
+
+    for (y = 0; y < LINES; y++)
+        for (x = 0; x < COLS; x++)
+        {
+            chtype ch = 'a' + (y + x) % 26;
+
+            mvwaddch(win[0], y, x, ch);
+            mvwaddch(win[1], y, x, step && x % step == 0 ?
+                     (ch == 'a' ? 'b' : 'a') | A_BOLD : ch);
+        }
+
+    wnoutrefresh(win[1]);
+    doupdate();
+    sent = SP->cells_sent;
+
+    start = seconds();
+
+    for (f = 0; f < frames; f++)
+    {
+        touchwin(win[f & 1]);
+        wnoutrefresh(win[f & 1]);
+        doupdate();
+    }
+
+    used = seconds() - start;
+
+    sprintf(name, "%dx%d %s", COLS, LINES, !step ? "same" :
+            step == 1 ? "all" : "sparse");
+    printf("%-16s %8.2f us/frame %8.1f Mcells/s %8.1f cells per frame\n",
+           name, used * 1e6 / frames,
+           used > 0 ? (double)frames * LINES * COLS / used / 1e6 : 0.0,
+           (double)(SP->cells_sent - sent) / frames);
+
+    delwin(win[0]);
+    delwin(win[1]);
+}
+
+/* the swapped screens are covered by a window refreshed after them, the
+   way panels are, so nothing really changes on the screen */
+
+static void covered(int lines, int cols, int frames)
+{
+    WINDOW *win[2], *top;
+    unsigned long sent;
+    double start, used;
+    char name[40];
+    int f, y;
+
+    if (resize_term(lines, cols) == ERR)
+        return;
+
+    win[0] = newwin(LINES, COLS, 0, 0);
+    win[1] = newwin(LINES, COLS, 0, 0);
+    top = newwin(LINES, COLS, 0, 0);
+
+    for (y = 0; y < LINES; y++)
+    {
+        mvwhline(win[0], y, 0, 'a', COLS);
+        mvwhline(win[1], y, 0, 'b', COLS);
+        mvwhline(top, y, 0, 'c', COLS);
+    }
+
+    wnoutrefresh(top);
+    doupdate();
+    sent = SP->cells_sent;
+
+    start = seconds();
+
+    for (f = 0; f < frames; f++)
+    {
+        touchwin(win[f & 1]);
+        wnoutrefresh(win[f & 1]);
+        touchwin(top);
+        wnoutrefresh(top);
+        doupdate();
+    }
+
+    used = seconds() - start;
+
+    sprintf(name, "%dx%d covered", COLS, LINES);
+    printf("%-16s %8.2f us/frame %8.1f Mcells/s %8.1f cells per frame\n",
+           name, used * 1e6 / frames,
+           used > 0 ? (double)frames * LINES * COLS / used / 1e6 : 0.0,
+           (double)(SP->cells_sent - sent) / frames);
+
+    delwin(win[0]);
+    delwin(win[1]);
+    delwin(top);
+}
+
+/* a log being tailed: every frame, a line of text comes in at the bottom
+   of a window as wide as the screen, and the rest scroll up */
+
+static void _log_line(WINDOW *win, int n)
+{
+    char text[1024];
+    int i, len = getmaxx(win) - 1;
+
+    if (len > (int)sizeof(text) - 1)
+        len = sizeof(text) - 1;
+
+    for (i = 0; i < len; i++)
+        text[i] = 'a' + (n * 7 + i * 13) % 26;
+
+    text[len] = '\0';
+
+    wprintw(win, "\n%s", text);
+}
+
+static void tail(int lines, int cols, int frames)
+{
+    WINDOW *win;
+    unsigned long sent;
+    double start, used;
+    char name[40];
+    int f;
+
+    if (resize_term(lines, cols) == ERR)
+        return;
+
+    win = newwin(LINES, COLS, 0, 0);
+    scrollok(win, TRUE);
+
+    for (f = 0; f < LINES; f++)
+        _log_line(win, f);
+
+    wrefresh(win);
+    sent = SP->cells_sent;
+
+    start = seconds();
+
+    for (f = 0; f < frames; f++)
+    {
+        _log_line(win, LINES + f);
+        wrefresh(win);
+    }
+
+    used = seconds() - start;
+
+    sprintf(name, "%dx%d tail", COLS, LINES);
+    printf("%-16s %8.2f us/frame %8.1f Mcells/s %8.1f cells per frame\n",
+           name, used * 1e6 / frames,
+           used > 0 ? (double)frames * LINES * COLS / used / 1e6 : 0.0,
+           (double)(SP->cells_sent - sent) / frames);
+
+    delwin(win);
+}
+
+/* formatted text alone, no refresh: every frame, each row of the screen
+   is printed over with a line of words, numbers and spaces */
+
+static void text(int lines, int cols, int frames)
+{
+    double start, used;
+    char name[40], words[512];
+    long chars = 0;
+    int f, y, len = cols - 16;
+
+    if (resize_term(lines, cols) == ERR)
+        return;
+
+    if (len > (int)sizeof(words) - 1)
+        len = sizeof(words) - 1;
+
+    for (y = 0; y < len; y++)
+        words[y] = (y % 6 == 5) ? ' ' : 'a' + y % 26;
+
+    words[len] = '\0';
+
+    start = seconds();
+
+    for (f = 0; f < frames; f++)
+        for (y = 0; y < LINES; y++)
+            chars += mvprintw(y, 0, "%6d %-6x %s", f, y, words + f % 6);
+
+    used = seconds() - start;
+
+    sprintf(name, "%dx%d printw", COLS, LINES);
+    printf("%-16s %8.2f us/frame %8.1f Mchars/s\n", name,
+           used * 1e6 / frames,
+           used > 0 ? chars / used / 1e6 : 0.0);
+
+    erase();
+}
+
+/* window life cycle: create, copy, resize and delete, big and small */
+
+static void windows(int lines, int cols, int count)
+{
+    double start, used;
+    char name[40];
+    int i;
+
+    start = seconds();
+
+    for (i = 0; i < count; i++)
+    {
+        WINDOW *win = newwin(lines, cols, 0, 0);
+        WINDOW *dup = dupwin(win);
+
+        wresize(dup, lines / 2, cols / 2);
+        wresize(win, lines, cols);
+        delwin(dup);
+        delwin(win);
+    }
+
+    used = seconds() - start;
+
+    sprintf(name, "%dx%d windows", cols, lines);
+    printf("%-16s %8.2f us/window\n", name, used * 1e6 / count);
+}
+
+int main(int argc, char **argv)
+{
+    int frames = argc > 1 ? atoi(argv[1]) : 10000;
+
+    /* queued before initscr(), they have to survive it */
+
+    PDC_mem_push_keys("ab");
+
+    initscr();
+    start_color();
+    cbreak();
+    noecho();
+    keypad(stdscr, TRUE);
+
+    check(pdc_mem_screen != NULL && LINES == pdc_mem_lines &&
+          COLS == pdc_mem_cols, "screen size");
+
+    /* text and attributes reach the framebuffer on refresh, not before */
+
+    init_pair(1, COLOR_RED, COLOR_BLUE);
+    mvaddstr(2, 3, "hello");
+    check(!screen_has(2, 3, "hello"), "nothing shown before refresh");
+    refresh();
+    check(screen_has(2, 3, "hello"), "text after refresh");
+
+    attron(COLOR_PAIR(1) | A_BOLD);
+    mvaddch(4, 0, 'X');
+    attroff(COLOR_PAIR(1) | A_BOLD);
+    refresh();
+    check((pdc_mem_screen[4 * pdc_mem_cols] & (A_COLOR | A_BOLD)) ==
+          (COLOR_PAIR(1) | A_BOLD), "attributes kept");
+
+    erase();
+    refresh();
+    check(screen_has(2, 3, "     "), "erase");
+
+    /* scrolled lines show up moved, whether or not the port moved them */
+
+    scrollok(stdscr, TRUE);
+    mvaddstr(0, 0, "first");
+    mvaddstr(1, 0, "second");
+    refresh();
+    scrl(1);
+    refresh();
+    check(screen_has(0, 0, "second") && screen_has(1, 0, "      "),
+          "scroll up");
+    scrl(-2);
+    refresh();
+    check(screen_has(0, 0, "      ") && screen_has(2, 0, "second"),
+          "scroll down");
+    scrollok(stdscr, FALSE);
+    erase();
+    refresh();
+
+    /* scripted keys come back in order, then nothing */
+
+    PDC_mem_push_key(KEY_UP);
+    check(getch() == 'a' && getch() == 'b', "keys pushed before initscr");
+    check(getch() == KEY_UP, "function key");
+    nodelay(stdscr, TRUE);
+    check(getch() == ERR, "empty queue");
+
+    if (frames > 0)
+    {
+        bench("full screen", frames, LINES);
+        bench("one row", frames, 1);
+        bench("no change", frames, 0);
+
+        /* full-screen churn on big terminals */
+
+        churn(100, 300, frames / 10, 1);
+        churn(100, 300, frames / 10, 3);
+        churn(100, 300, frames / 10, 0);
+        covered(100, 300, frames / 10);
+        churn(200, 600, frames / 40, 1);
+        churn(200, 600, frames / 40, 3);
+        churn(200, 600, frames / 40, 0);
+        covered(200, 600, frames / 40);
+        tail(100, 300, frames / 10);
+        tail(200, 600, frames / 40);
+        text(100, 300, frames / 10);
+
+        /* windows on the last screen size */
+
+        windows(LINES, COLS, frames / 40);
+        windows(10, 20, frames * 10);
+    }
+
+    endwin();
+
+    printf("memtest: %d checks, %d failed\n", checks, failures);
+
+    return failures ? 1 : 0;
+}
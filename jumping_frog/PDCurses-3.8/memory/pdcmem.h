@@ -0,0 +1,16 @@
+/* PDCurses */
+
+#include <curspriv.h>
+
+#define PDC_MEM_MAXKEYS 256         /* scripted keys waiting to be read */
+
+PDCEX  chtype *pdc_mem_screen;      /* lines * cols cells, what a real
+                                       display would be showing */
+PDCEX  int pdc_mem_lines, pdc_mem_cols;
+PDCEX  int pdc_mem_key_delay;       /* ms between two scripted keys */
+
+PDCEX  int PDC_mem_push_key(int key);
+PDCEX  int PDC_mem_push_keys(const char *keys);
+PDCEX  int PDC_mem_dump(const char *filename);
+
+extern unsigned long PDC_mem_ms(void);
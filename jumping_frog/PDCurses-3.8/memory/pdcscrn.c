@@ -0,0 +1,206 @@
+/* PDCurses */
+
+#include "pdcmem.h"
+
+#include <stdlib.h>
+
+/* COLOR_PAIR to attribute encoding table. */
+
+static struct {short f, b;} atrtab[PDC_COLOR_PAIRS];
+
+/* the palette only answers color_content(), nothing is drawn with it */
+
+static struct {short r, g, b;} palette[256];
+
+static int _env_int(const char *name, int fallback)
+{
+    const char *env = getenv(name);
+    int value = env ? atoi(env) : 0;
+
+    return value > 0 ? value : fallback;
+}
+
+static int _alloc_screen(int nlines, int ncols)
+{
+    chtype *screen;
+    long i;
+
+    screen = malloc((long)nlines * ncols * sizeof(chtype));
+    if (!screen)
+        return ERR;
+
+    for (i = 0; i < (long)nlines * ncols; i++)
+        screen[i] = ' ';
+
+    free(pdc_mem_screen);
+    pdc_mem_screen = screen;
+    pdc_mem_lines = nlines;
+    pdc_mem_cols = ncols;
+
+    return OK;
+}
+
+static void _initialize_colors(void)
+{
+    int i, r, g, b;
+
+    /* the same 256 colors as the SDL ports, in curses' 0..1000 scale */
+
+    for (i = 0; i < 8; i++)
+    {
+        palette[i].r = (i & COLOR_RED) ? 753 : 0;
+        palette[i].g = (i & COLOR_GREEN) ? 753 : 0;
+        palette[i].b = (i & COLOR_BLUE) ? 753 : 0;
+
+        palette[i + 8].r = (i & COLOR_RED) ? 1000 : 251;
+        palette[i + 8].g = (i & COLOR_GREEN) ? 1000 : 251;
+        palette[i + 8].b = (i & COLOR_BLUE) ? 1000 : 251;
+    }
+
+    for (i = 16, r = 0; r < 6; r++)
+        for (g = 0; g < 6; g++)
+            for (b = 0; b < 6; b++, i++)
+            {
+                palette[i].r = r ? DIVROUND((r * 40 + 55) * 1000, 255) : 0;
+                palette[i].g = g ? DIVROUND((g * 40 + 55) * 1000, 255) : 0;
+                palette[i].b = b ? DIVROUND((b * 40 + 55) * 1000, 255) : 0;
+            }
+
+    for (i = 232; i < 256; i++)
+        palette[i].r = palette[i].g = palette[i].b =
+            DIVROUND(((i - 232) * 10 + 8) * 1000, 255);
+}
+
+void PDC_scr_close(void)
+{
+    PDC_LOG(("PDC_scr_close() - called\n"));
+
+    /* leave the last screen behind for whoever runs the program */
+
+    PDC_mem_dump(getenv("PDC_DUMP"));
+}
+
+void PDC_scr_free(void)
+{
+    if (SP)
+        free(SP);
+
+    free(pdc_mem_screen);
+    pdc_mem_screen = NULL;
+}
+
+/* open the physical screen -- allocate SP, miscellaneous intialization */
+
+int PDC_scr_open(int argc, char **argv)
+{
+    const char *keys;
+
+    PDC_LOG(("PDC_scr_open() - called\n"));
+
+    SP = calloc(1, sizeof(SCREEN));
+
+    if (!SP || _alloc_screen(_env_int("PDC_LINES", 25),
+                             _env_int("PDC_COLS", 80)) == ERR)
+        return ERR;
+
+    _initialize_colors();
+
+    /* a script can come from the environment, so a program runs
+       unchanged with keys typed for it */
+
+    keys = getenv("PDC_KEYS");
+    if (keys)
+        PDC_mem_push_keys(keys);
+
+    pdc_mem_key_delay = _env_int("PDC_KEY_DELAY", pdc_mem_key_delay);
+
+    SP->mono = FALSE;
+    SP->orig_attr = FALSE;
+
+    SP->lines = PDC_get_rows();
+    SP->cols = PDC_get_columns();
+
+    SP->mouse_wait = PDC_CLICK_PERIOD;
+    SP->audible = FALSE;
+
+    SP->termattrs = A_COLOR | A_UNDERLINE | A_LEFT | A_RIGHT | A_REVERSE |
+                    A_ITALIC;
+
+    PDC_reset_prog_mode();
+
+    return OK;
+}
+
+/* the core of resize_term() */
+
+int PDC_resize_screen(int nlines, int ncols)
+{
+    PDC_LOG(("PDC_resize_screen() - called. Lines: %d Cols: %d\n",
+             nlines, ncols));
+
+    if (nlines && ncols && _alloc_screen(nlines, ncols) == ERR)
+        return ERR;
+
+    SP->resized = FALSE;
+    SP->cursrow = SP->curscol = 0;
+
+    return OK;
+}
+
+/* scripted keys are meant to be read, don't flush them like the other
+   ports do when switching modes */
+
+void PDC_reset_prog_mode(void)
+{
+    PDC_LOG(("PDC_reset_prog_mode() - called.\n"));
+}
+
+void PDC_reset_shell_mode(void)
+{
+    PDC_LOG(("PDC_reset_shell_mode() - called.\n"));
+}
+
+void PDC_restore_screen_mode(int i)
+{
+}
+
+void PDC_save_screen_mode(int i)
+{
+}
+
+void PDC_init_pair(short pair, short fg, short bg)
+{
+    atrtab[pair].f = fg;
+    atrtab[pair].b = bg;
+}
+
+int PDC_pair_content(short pair, short *fg, short *bg)
+{
+    *fg = atrtab[pair].f;
+    *bg = atrtab[pair].b;
+
+    return OK;
+}
+
+bool PDC_can_change_color(void)
+{
+    return TRUE;
+}
+
+int PDC_color_content(short color, short *red, short *green, short *blue)
+{
+    *red = palette[color].r;
+    *green = palette[color].g;
+    *blue = palette[color].b;
+
+    return OK;
+}
+
+int PDC_init_color(short color, short red, short green, short blue)
+{
+    palette[color].r = red;
+    palette[color].g = green;
+    palette[color].b = blue;
+
+    return OK;
+}
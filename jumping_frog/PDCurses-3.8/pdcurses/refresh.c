@@ -42,6 +42,10 @@ refresh
    implementations, there's a subtle distinction, but it has no
    meaning in PDCurses.
 
+   SP->lines_sent and SP->cells_sent add up how many lines and cells
+   doupdate() has sent to the display, i.e. what really changed on
+   the screen. They can be reset at will.
+
 ### Return Value
 
    All functions return OK on success and ERR on error.
@@ -59,6 +63,232 @@ refresh
 
 #include <string.h>
 
+/* Changed cells are found by comparing a line against what's already on
+   the screen. The compares run a vector of cells at a time where the
+   compiler offers one (define PDC_NO_SIMD to force the plain loops);
+   chtype is 32 bits on every supported platform. */
+
+#ifndef PDC_NO_SIMD
+# if defined(__AVX2__)
+#  include <immintrin.h>
+#  define PDC_SIMD_CELLS 8
+# elif defined(__SSE2__) || defined(_M_X64) || \
+       (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define PDC_SIMD_CELLS 4
+# elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#  include <arm_neon.h>
+#  define PDC_SIMD_CELLS 4
+# endif
+#endif
+
+#ifdef PDC_SIMD_CELLS
+
+/* a mask with bit 4 * i set where cell i of a and b is the same; all
+   the same -- _ALL_SAME, none -- 0 */
+
+# if defined(__AVX2__)
+#  define _ALL_SAME (int)0x11111111
+static int _same_mask(const chtype *a, const chtype *b)
+{
+    __m256i eq = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *)a),
+                                    _mm256_loadu_si256((const __m256i *)b));
+
+    return _mm256_movemask_epi8(eq) & _ALL_SAME;
+}
+# elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#  define _ALL_SAME 0x1111
+static int _same_mask(const chtype *a, const chtype *b)
+{
+    uint32x4_t eq = vceqq_u32(vld1q_u32((const uint32_t *)a),
+                              vld1q_u32((const uint32_t *)b));
+
+    return (vgetq_lane_u32(eq, 0) & 0x0001) |
+           (vgetq_lane_u32(eq, 1) & 0x0010) |
+           (vgetq_lane_u32(eq, 2) & 0x0100) |
+           (vgetq_lane_u32(eq, 3) & 0x1000);
+}
+# else
+#  define _ALL_SAME 0x1111
+static int _same_mask(const chtype *a, const chtype *b)
+{
+    __m128i eq = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *)a),
+                                 _mm_loadu_si128((const __m128i *)b));
+
+    return _mm_movemask_epi8(eq) & _ALL_SAME;
+}
+# endif
+
+#endif
+
+/* first cell from first to last where a and b differ, last + 1 if none */
+
+static int _next_changed(const chtype *a, const chtype *b,
+                         int first, int last)
+{
+#ifdef PDC_SIMD_CELLS
+    while (last - first + 1 >= PDC_SIMD_CELLS)
+    {
+        int mask = _same_mask(a + first, b + first);
+
+        if (mask != _ALL_SAME)
+        {
+            while (mask & 1)
+            {
+                mask >>= 4;
+                first++;
+            }
+
+            return first;
+        }
+
+        first += PDC_SIMD_CELLS;
+    }
+#endif
+    while (first <= last && a[first] == b[first])
+        first++;
+
+    return first;
+}
+
+/* first cell from first to last where a and b are the same, last + 1 if
+   none */
+
+static int _next_same(const chtype *a, const chtype *b, int first, int last)
+{
+#ifdef PDC_SIMD_CELLS
+    while (last - first + 1 >= PDC_SIMD_CELLS)
+    {
+        int mask = _same_mask(a + first, b + first);
+
+        if (mask)
+        {
+            while (!(mask & 1))
+            {
+                mask >>= 4;
+                first++;
+            }
+
+            return first;
+        }
+
+        first += PDC_SIMD_CELLS;
+    }
+#endif
+    while (first <= last && a[first] != b[first])
+        first++;
+
+    return first;
+}
+
+/* last cell from last down to first where a and b differ, first - 1 if
+   none */
+
+static int _prev_changed(const chtype *a, const chtype *b,
+                         int first, int last)
+{
+#ifdef PDC_SIMD_CELLS
+    while (last - first + 1 >= PDC_SIMD_CELLS &&
+           _same_mask(a + last - PDC_SIMD_CELLS + 1,
+                      b + last - PDC_SIMD_CELLS + 1) == _ALL_SAME)
+        last -= PDC_SIMD_CELLS;
+#endif
+    while (last >= first && a[last] == b[last])
+        last--;
+
+    return last;
+}
+
+/* end of the run of changed cells starting at first: one past its last
+   cell. If two runs are separated by a single unchanged cell, the break
+   is ignored, since sending one cell costs less than starting a new
+   run */
+
+static int _run_end(const chtype *src, const chtype *dest,
+                    int first, int last)
+{
+    int end = _next_same(src, dest, first, last);
+
+    while (end < last && src[end + 1] != dest[end + 1])
+        end = _next_same(src, dest, end + 1, last);
+
+    return end;
+}
+
+/* A scroll of a window as wide as the screen can be left to the port,
+   which moves what it already shows instead of having every cell sent
+   again. wscrl() notes the scroll here, wnoutrefresh() of the same
+   window places it on the screen, and doupdate() has it done before
+   comparing. Only the latest one is kept; losing it costs output, not
+   correctness, as pdc_lastscr follows whatever the port did. */
+
+static WINDOW *scroll_win = NULL;
+static int scroll_tmarg, scroll_bmarg, scroll_n;
+static int scroll_top, scroll_bottom;
+static bool scroll_ready = FALSE;
+
+void PDC_scrolled(WINDOW *win, int n)
+{
+    if (win == scroll_win && win->_tmarg == scroll_tmarg &&
+        win->_bmarg == scroll_bmarg)
+        scroll_n += n;
+    else
+    {
+        scroll_win = win;
+        scroll_tmarg = win->_tmarg;
+        scroll_bmarg = win->_bmarg;
+        scroll_n = n;
+        scroll_ready = FALSE;
+    }
+}
+
+/* scroll the screen as noted, if the port can, and pdc_lastscr along
+   with it */
+
+static void _scroll_screen(void)
+{
+    int height = scroll_bottom - scroll_top + 1;
+    int y, x, first, last, n = scroll_n;
+
+    if (scroll_bottom >= SP->lines || n >= height || -n >= height ||
+        !n || !PDC_scroll(scroll_top, scroll_bottom, n))
+        return;
+
+    PDC_rotate_lines(pdc_lastscr->_y + scroll_top, height, n);
+
+    /* the lines scrolled in still show what they did before, which is
+       now on the line n away, unless that went round too */
+
+    if (n > 0)
+    {
+        first = scroll_bottom - n + 1;
+        last = scroll_bottom;
+    }
+    else
+    {
+        first = scroll_top;
+        last = scroll_top - n - 1;
+    }
+
+    for (y = first; y <= last; y++)
+    {
+        if (y - n >= scroll_top && y - n <= scroll_bottom)
+            memcpy(pdc_lastscr->_y[y], pdc_lastscr->_y[y - n],
+                   SP->cols * sizeof(chtype));
+        else
+            for (x = 0; x < SP->cols; x++)
+                pdc_lastscr->_y[y][x] = (chtype)(-1);
+    }
+
+    /* every line of the region is now compared again */
+
+    for (y = scroll_top; y <= scroll_bottom; y++)
+    {
+        curscr->_firstch[y] = 0;
+        curscr->_lastch[y] = SP->cols - 1;
+    }
+}
+
 int wnoutrefresh(WINDOW *win)
 {
     int begy, begx;     /* window's place on screen   */
@@ -85,11 +315,8 @@ int wnoutrefresh(WINDOW *win)
             /* ignore areas on the outside that are marked as changed,
                but really aren't */
 
-            while (first <= last && src[first] == dest[first])
-                first++;
-
-            while (last >= first && src[last] == dest[last])
-                last--;
+            first = _next_changed(src, dest, first, last);
+            last = _prev_changed(src, dest, first, last);
 
             /* if any have really changed... */
 
@@ -115,6 +342,13 @@ int wnoutrefresh(WINDOW *win)
         win->_lastch[i] = _NO_CHANGE;       /* updated now */
     }
 
+    if (win == scroll_win && !begx && win->_maxx == SP->cols)
+    {
+        scroll_top = begy + scroll_tmarg;
+        scroll_bottom = begy + scroll_bmarg;
+        scroll_ready = TRUE;
+    }
+
     if (win->_clear)
         win->_clear = FALSE;
 
@@ -146,6 +380,12 @@ int doupdate(void)
     else
         clearall = curscr->_clear;
 
+    if (scroll_ready && !clearall)
+        _scroll_screen();
+
+    scroll_win = NULL;
+    scroll_ready = FALSE;
+
     for (y = 0; y < SP->lines; y++)
     {
         PDC_LOG(("doupdate() - Transforming line %d of %d: %s\n",
@@ -170,38 +410,29 @@ int doupdate(void)
                 last = curscr->_lastch[y];
             }
 
+            /* skip over unchanged cells, then send each run of changed
+               ones */
+
+            if (!clearall)
+                first = _next_changed(src, dest, first, last);
+
+            if (first <= last)
+                SP->lines_sent++;
+
             while (first <= last)
             {
-                int len = 0;
-
-                /* build up a run of changed cells; if two runs are
-                   separated by a single unchanged cell, ignore the
-                   break */
-
-                if (clearall)
-                    len = last - first + 1;
-                else
-                    while (first + len <= last &&
-                           (src[first + len] != dest[first + len] ||
-                            (len && first + len < last &&
-                             src[first + len + 1] != dest[first + len + 1])
-                           )
-                          )
-                        len++;
+                int end = clearall ? last + 1 :
+                          _run_end(src, dest, first, last);
 
                 /* update the screen, and pdc_lastscr */
 
-                if (len)
-                {
-                    PDC_transform_line(y, first, len, src + first);
-                    memcpy(dest + first, src + first, len * sizeof(chtype));
-                    first += len;
-                }
+                PDC_transform_line(y, first, end - first, src + first);
+                memcpy(dest + first, src + first,
+                       (end - first) * sizeof(chtype));
 
-                /* skip over runs of unchanged cells */
+                SP->cells_sent += end - first;
 
-                while (first <= last && src[first] == dest[first])
-                    first++;
+                first = _next_changed(src, dest, end, last);
             }
 
             curscr->_firstch[y] = _NO_CHANGE;
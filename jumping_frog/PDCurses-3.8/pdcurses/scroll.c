@@ -26,6 +26,11 @@ scroll
    scrollok(). Note also that scrolling is not allowed if the
    supplied window is a pad.
 
+   When the window spans the width of the screen, the next
+   doupdate() asks the display to move the lines that are already
+   there, if the port can, and then sends only the ones scrolled
+   in.
+
 ### Return Value
 
    All functions return OK on success and ERR on error.
@@ -38,9 +43,42 @@ scroll
 
 **man-end****************************************************************/
 
+#include <string.h>
+
+/* reverse the order of count line pointers */
+
+static void _reverse(chtype **lines, int count)
+{
+    int i, j;
+
+    for (i = 0, j = count - 1; i < j; i++, j--)
+    {
+        chtype *temp = lines[i];
+
+        lines[i] = lines[j];
+        lines[j] = temp;
+    }
+}
+
+/* move count line pointers up by n (down if n is negative) in one go,
+   the ones pushed off one end coming back in at the other */
+
+void PDC_rotate_lines(chtype **lines, int count, int n)
+{
+    if (n < 0)
+        n += count;
+
+    if (n <= 0 || n >= count)
+        return;
+
+    _reverse(lines, n);
+    _reverse(lines + n, count - n);
+    _reverse(lines, count);
+}
+
 int wscrl(WINDOW *win, int n)
 {
-    int i, l, dir, start, end;
+    int i, l, start, height;
     chtype blank, *temp;
 
     /* Check if window scrolls. Valid for window AND pad */
@@ -50,38 +88,33 @@ int wscrl(WINDOW *win, int n)
 
     blank = win->_bkgd;
 
-    if (n > 0)
-    {
-        start = win->_tmarg;
-        end = win->_bmarg;
-        dir = 1;
-    }
-    else
-    {
-        start = win->_bmarg;
-        end = win->_tmarg;
-        dir = -1;
-    }
+    start = win->_tmarg;
+    height = win->_bmarg - win->_tmarg + 1;
 
-    for (l = 0; l < (n * dir); l++)
-    {
-        temp = win->_y[start];
+    /* however many lines it is, the region's line pointers are rotated
+       once; the lines that wrap around are the only ones to blank */
+
+    l = (n > 0) ? n : -n;
 
-        /* re-arrange line pointers */
+    if (l < height)
+        PDC_rotate_lines(win->_y + start, height, n);
+    else
+        l = height;
 
-        for (i = start; i != end; i += dir)
-            win->_y[i] = win->_y[i + dir];
+    if (n > 0)
+        start += height - l;
 
-        win->_y[end] = temp;
+    temp = win->_y[start];
 
-        /* make a blank line */
+    for (i = 0; i < win->_maxx; i++)
+        temp[i] = blank;
 
-        for (i = 0; i < win->_maxx; i++)
-            *temp++ = blank;
-    }
+    for (i = 1; i < l; i++)
+        memcpy(win->_y[start + i], temp, win->_maxx * sizeof(chtype));
 
-    touchline(win, win->_tmarg, win->_bmarg - win->_tmarg + 1);
+    touchline(win, win->_tmarg, height);
 
+    PDC_scrolled(win, n);
     PDC_sync(win);
     return OK;
 }
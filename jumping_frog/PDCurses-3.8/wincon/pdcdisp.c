@@ -213,6 +213,18 @@ void _new_packet(attr_t attr, int lineno, int x, int len, const chtype *srcp)
     }
 }
 
+/* the console isn't scrolled here -- ScrollConsoleScreenBuffer()
+   would do, but not for the ANSI output -- so doupdate() sends the lines
+   instead */
+
+bool PDC_scroll(int top, int bottom, int n)
+{
+    PDC_LOG(("PDC_scroll() - called: top %d bottom %d n %d\n",
+             top, bottom, n));
+
+    return FALSE;
+}
+
 /* update the given physical line to look like the corresponding line in
    curscr */
 
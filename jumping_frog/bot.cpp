@@ -0,0 +1,245 @@
+#include <stdio.h>
+#include <math.h>
+#include "bot.h"
+#include "clock.h"
+
+
+
+//-------------------
+//-----PREDICTION----
+//-------------------
+
+void initBot(Bot* bot, const GameState* state, int horizon, double budget_us) {
+	bot->horizon = horizon > 0 ? horizon : BOT_HORIZON;
+	bot->budget = budget_us * 1e-6;
+	bot->height = state->height;
+	bot->row_words = state->row_words;
+	int ticks = bot->horizon + BOT_JUMP_TICKS;
+	bot->safe.assign((size_t)ticks * state->height * state->row_words, 0);
+	bot->landing.assign((size_t)bot->horizon * state->height * state->row_words, 0);
+	bot->seen.assign((size_t)bot->horizon * state->height * state->row_words, 0);
+	bot->open.assign((size_t)state->height * state->row_words, 0);
+}
+
+int botCanJump(GameState* state) {
+	//what letAnotherDetect will decide for a key pressed on the next tick
+	return !state->inputDetected || state->timer + TIMER_ADDITION - state->save_timer > DELAY_AFTER_JUMP;
+}
+
+void predictCars(Bot* bot, GameState* state, CarTable* cars) {
+	//moveCars on a copy, only aggressive cars cost anything to run into. Cars that
+	//respawn in the meantime get a random kind, the bot cannot know it and ignores them
+	int words = bot->row_words;
+	int ticks = bot->horizon + BOT_JUMP_TICKS;
+	bot->future = *cars;
+	for (size_t i = 0; i < bot->safe.size(); i++) {
+		bot->safe[i] = ~0ull;
+	}
+	for (int t = 0; t < ticks; t++) {
+		moveCars(&bot->future, state);
+		uint64_t* rows = &bot->safe[(size_t)t * bot->height * words];
+		for (int i = 0; i < bot->future.count; i++) {
+			unsigned char flags = bot->future.flags[i];
+			if (!(bot->future.kind[i] & CAR_AGGRESSIVE) || !(flags & CAR_INITIALIZED)) {
+				continue;
+			}
+			//the cells hits() counts as touching the car
+			float x = bot->future.x[i];
+			int low = (int)ceilf(x - state->r);
+			int high = (int)floorf(x + state->r);
+			low = low > 0 ? low : 0;
+			high = high < state->width - 1 ? high : state->width - 1;
+			uint64_t* row = &rows[bot->future.y[i] * words];
+			for (int cell = low; cell <= high; cell++) {
+				row[cell >> 6] &= ~(1ull << (cell & 63));
+			}
+		}
+	}
+}
+
+void buildLandings(Bot* bot) {
+	//a jump leaves the frog on its cell for a whole jump delay, every tick of it has to be safe
+	size_t stride = (size_t)bot->height * bot->row_words;
+	for (int t = 0; t < bot->horizon; t++) {
+		uint64_t* landing = &bot->landing[t * stride];
+		const uint64_t* safe = &bot->safe[t * stride];
+		for (size_t w = 0; w < stride; w++) {
+			landing[w] = safe[w];
+		}
+		for (int j = 1; j < BOT_JUMP_TICKS; j++) {
+			const uint64_t* later = &bot->safe[(t + j) * stride];
+			for (size_t w = 0; w < stride; w++) {
+				landing[w] &= later[w];
+			}
+		}
+	}
+}
+
+
+
+//-------------------
+//------PLANNING-----
+//-------------------
+
+void buildOpen(Bot* bot, GameState* state) {
+	//the cells upCase/downCase/leftCase/rightCase let the frog onto: x in [2, width-2], no obstacle
+	int words = bot->row_words;
+	for (int y = 0; y < bot->height; y++) {
+		for (int w = 0; w < words; w++) {
+			uint64_t bounds = 0;
+			for (int bit = 0; bit < 64; bit++) {
+				int x = w * 64 + bit;
+				if (x >= 2 && x <= state->width - 2) {
+					bounds |= 1ull << bit;
+				}
+			}
+			bot->open[y * words + w] = bounds & ~state->obstacles[y * words + w];
+		}
+	}
+}
+
+int searchFrom(Bot* bot, GameState* state, int action, int limit, double deadline, int* best_y) {
+	//floods whole rows of reachable cells tick by tick after pressing action now,
+	//returns the tick the frog can jump into the finish lane, limit if it cannot
+	//before then, -1 when the time ran out
+	int words = bot->row_words;
+	int height = bot->height;
+	size_t stride = (size_t)height * words;
+	int y = state->frog_y;
+	int x = state->frog_x;
+	*best_y = height;
+	for (size_t i = 0; i < (size_t)limit * stride; i++) {
+		bot->seen[i] = 0;
+	}
+	//the first move, the one the caller would press
+	uint64_t bit = 1ull << (x & 63);
+	if (action == INPUT_NONE) {
+		if (!(bot->safe[y * words + (x >> 6)] & bit)) {
+			return limit;
+		}
+		if (1 < limit) {
+			bot->seen[stride + y * words + (x >> 6)] |= bit;
+		}
+		*best_y = y;
+	}
+	else {
+		y += action == INPUT_UP ? -1 : action == INPUT_DOWN ? 1 : 0;
+		x += action == INPUT_LEFT ? -1 : action == INPUT_RIGHT ? 1 : 0;
+		bit = 1ull << (x & 63);
+		if (y < 1 || y > height - 2 || !(bot->open[y * words + (x >> 6)] & bit)) {
+			return limit;
+		}
+		if (y == 1) {
+			return 0;
+		}
+		if (!(bot->landing[y * words + (x >> 6)] & bit)) {
+			return limit;
+		}
+		if (BOT_JUMP_TICKS < limit) {
+			bot->seen[BOT_JUMP_TICKS * stride + y * words + (x >> 6)] |= bit;
+		}
+		*best_y = y;
+	}
+	for (int t = 1; t < limit; t++) {
+		if (deadline > 0 && t % BOT_CHECK_EVERY == 0 && clockNow() > deadline) {
+			return -1;
+		}
+		const uint64_t* seen = &bot->seen[t * stride];
+		const uint64_t* safe = &bot->safe[t * stride];
+		const uint64_t* landing = &bot->landing[t * stride];
+		uint64_t* wait = t + 1 < limit ? &bot->seen[(t + 1) * stride] : NULL;
+		uint64_t* jump = t + BOT_JUMP_TICKS < limit ? &bot->seen[(t + BOT_JUMP_TICKS) * stride] : NULL;
+		for (y = 1; y < height - 1; y++) {
+			const uint64_t* row = &seen[y * words];
+			for (int w = 0; w < words; w++) {
+				uint64_t cells = row[w];
+				if (cells == 0) {
+					continue;
+				}
+				if (y - 1 == 1 && (cells & bot->open[words + w])) {
+					return t;
+				}
+				if (wait != NULL) {
+					wait[y * words + w] |= cells & safe[y * words + w];
+				}
+				uint64_t left = (cells >> 1) | (w + 1 < words ? row[w + 1] << 63 : 0);
+				uint64_t right = (cells << 1) | (w > 0 ? row[w - 1] >> 63 : 0);
+				uint64_t up = cells & bot->open[(y - 1) * words + w] & landing[(y - 1) * words + w];
+				uint64_t down = y + 1 < height - 1 ? cells & bot->open[(y + 1) * words + w] & landing[(y + 1) * words + w] : 0;
+				uint64_t side = (left | right) & bot->open[y * words + w] & landing[y * words + w];
+				if (up != 0 && y - 1 < *best_y) {
+					*best_y = y - 1;
+				}
+				if (jump != NULL) {
+					jump[(y - 1) * words + w] |= up;
+					jump[y * words + w] |= side;
+					if (down != 0) {
+						jump[(y + 1) * words + w] |= down;
+					}
+				}
+			}
+		}
+	}
+	return limit;
+}
+
+int planMove(Bot* bot, GameState* state) {
+	//one search per key the bot could press now, the earliest way into the finish
+	//lane wins. Without one in the horizon it heads for the highest row it can reach
+	//safely. Forward first, so running out of time still leaves a sensible move
+	static const int actions[] = { INPUT_UP, INPUT_LEFT, INPUT_RIGHT, INPUT_NONE, INPUT_DOWN };
+	double deadline = bot->budget > 0 ? clockNow() + bot->budget : 0;
+	int best_finish = bot->horizon;
+	int best_y = state->frog_y;
+	int best_move = INPUT_NONE;
+	buildOpen(bot, state);
+	for (int i = 0; i < (int)(sizeof(actions) / sizeof(actions[0])); i++) {
+		int reached_y;
+		int finish = searchFrom(bot, state, actions[i], best_finish, deadline, &reached_y);
+		if (finish < 0) {
+			bot->over_budget++;
+			break;
+		}
+		if (finish < best_finish) {
+			best_finish = finish;
+			best_move = actions[i];
+		}
+		else if (best_finish == bot->horizon && reached_y < best_y) {
+			best_y = reached_y;
+			best_move = actions[i];
+		}
+	}
+	return best_move;
+}
+
+int botInput(Bot* bot, GameState* state, CarTable* cars, InputEvent* input) {
+	//the key the bot presses on the next tick, 0 - none
+	input->action = INPUT_NONE;
+	input->time = -1;
+	if (state->awaiting) {
+		//a frog waiting to be picked up cannot jump, press pick up again to cancel
+		input->action = INPUT_PICK_UP;
+		return 1;
+	}
+	if (!botCanJump(state)) {
+		return 0;
+	}
+	double start = clockNow();
+	predictCars(bot, state, cars);
+	buildLandings(bot);
+	input->action = planMove(bot, state);
+	bot->plans++;
+	bot->plan_seconds += clockNow() - start;
+	return input->action != INPUT_NONE;
+}
+
+void mergeBotStats(Bot* into, const Bot* from) {
+	into->plans += from->plans;
+	into->over_budget += from->over_budget;
+	into->plan_seconds += from->plan_seconds;
+}
+
+void printBotStats(const Bot* bot) {
+	printf("bot plans:   %lld, %.1f us each, %lld over budget\n", bot->plans,
+		bot->plans > 0 ? bot->plan_seconds * 1e6 / bot->plans : 0.0, bot->over_budget);
+}
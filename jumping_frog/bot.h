@@ -0,0 +1,51 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+#include "game.h"
+
+#define BOT_HORIZON				256 // ticks the planner looks ahead
+#define BOT_BUDGET_US			1000 // planning time per tick, 0 - unlimited and repeatable
+#define BOT_CHECK_EVERY			16 // ticks searched between looks at the clock
+#define BOT_JUMP_TICKS			((int)(DELAY_AFTER_JUMP / TIMER_ADDITION) + 1) // ticks before the frog can jump again
+
+
+
+//-------------------
+//------STRUCTS------
+//-------------------
+// plays the frog by searching (tick, cell) states against where the aggressive
+// cars will be, a row of cells at a time. All scratch is sized once and reused
+typedef struct Bot {
+	int horizon = BOT_HORIZON;
+	double budget = BOT_BUDGET_US * 1e-6; // seconds
+	int row_words = 0;
+	int height = 0;
+	CarTable future; // the cars moved ahead tick by tick
+	std::vector<uint64_t> safe; // ((t * height) + y) * row_words, bit x - no aggressive car on the cell after tick t
+	std::vector<uint64_t> landing; // safe for every tick of a jump delay starting at t
+	std::vector<uint64_t> seen; // cells the frog can be on, free to jump, at tick t - same layout as safe
+	std::vector<uint64_t> open; // y * row_words, cells a jump may end on
+	long long plans = 0;
+	long long over_budget = 0;
+	double plan_seconds = 0;
+} Bot;
+
+
+
+//-------------------
+//----DECLARATIONS---
+//-------------------
+
+// Prediction functions
+void initBot(Bot* bot, const GameState* state, int horizon, double budget_us);
+int botCanJump(GameState* state);
+void predictCars(Bot* bot, GameState* state, CarTable* cars);
+void buildLandings(Bot* bot);
+
+// Planning functions
+void buildOpen(Bot* bot, GameState* state);
+int searchFrom(Bot* bot, GameState* state, int action, int limit, double deadline, int* best_y);
+int planMove(Bot* bot, GameState* state);
+int botInput(Bot* bot, GameState* state, CarTable* cars, InputEvent* input);
+void mergeBotStats(Bot* into, const Bot* from);
+void printBotStats(const Bot* bot);
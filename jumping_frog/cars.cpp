@@ -0,0 +1,210 @@
+#include <string.h>
+#include "game.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define CAR_KERNEL_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CAR_KERNEL_SSE2
+#endif
+
+
+
+//-------------------
+//-----CAR TABLE-----
+//-------------------
+
+void initCarTable(CarTable* cars, int count) {
+	cars->count = count;
+	cars->x.assign(count, 0);
+	cars->speed.assign(count, 0);
+	cars->direction.assign(count, 0);
+	cars->y.assign(count, 0);
+	cars->iters.assign(count, 0);
+	cars->color.assign(count, 0);
+	cars->symbol.assign(count, ' ');
+	cars->kind.assign(count, 0);
+	cars->flags.assign(count, 0);
+}
+
+
+
+//-------------------
+//-------MOVING------
+//-------------------
+
+void moveCarsScalar(CarTable* cars, int begin, int end, GameState* state) {
+	for (int i = begin; i < end; i++) {
+		if (!(cars->flags[i] & CAR_STOPPED)) {
+			bounceCar(cars, i, state);
+			wrapCar(cars, i, state);
+			disappearCar(cars, i, state);
+			if (cars->direction[i] > 0) {
+				cars->x[i] += cars->speed[i] * CAR_SPEED_VAR;
+			}
+			else if (cars->direction[i] < 0) {
+				cars->x[i] -= cars->speed[i] * CAR_SPEED_VAR;
+			}
+		}
+	}
+}
+
+void carEdgeEvents(CarTable* cars, int i, GameState* state) {
+	//the rare part of a car reaching an edge, the kernel already moved and turned it
+	unsigned char kind = cars->kind[i];
+	if (kind & CAR_DISAPPEARING) {
+		cars->flags[i] &= ~(CAR_RIDDEN | CAR_INITIALIZED);
+		return;
+	}
+	cars->iters[i]++;
+	changeCarAfterNumOfIters(kind & CAR_BOUNCING ? state->number_of_bounces : state->number_of_wraps, cars, i);
+}
+
+#if defined(CAR_KERNEL_AVX2)
+
+inline __m256d carMask(const unsigned char* bytes, int bits) {
+	//4 bytes -> 4 all-ones/all-zeros 64 bit lanes, set where any of bits is set
+	int packed;
+	memcpy(&packed, bytes, sizeof(packed));
+	__m256i wide = _mm256_cvtepu8_epi64(_mm_cvtsi32_si128(packed));
+	__m256i set = _mm256_and_si256(wide, _mm256_set1_epi64x(bits));
+	return _mm256_castsi256_pd(_mm256_cmpgt_epi64(set, _mm256_setzero_si256()));
+}
+
+int moveCarsKernel(CarTable* cars, GameState* state) {
+	//4 cars per step in double precision, the same arithmetic the scalar path does
+	//after float -> double promotion, so both paths leave identical positions
+	int count = cars->count & ~3;
+	const __m256d zero = _mm256_setzero_pd();
+	const __m256d width = _mm256_set1_pd(state->width);
+	const __m256d speed_var = _mm256_set1_pd(CAR_SPEED_VAR);
+	const __m256d right = _mm256_set1_pd(1.0);
+	const __m256d left = _mm256_set1_pd(-1.0);
+	for (int i = 0; i < count; i += 4) {
+		__m256d old_x = _mm256_cvtps_pd(_mm_loadu_ps(&cars->x[i]));
+		__m256d step = _mm256_mul_pd(_mm256_cvtps_pd(_mm_loadu_ps(&cars->speed[i])), speed_var);
+		__m256d old_direction = _mm256_cvtps_pd(_mm_loadu_ps(&cars->direction[i]));
+		__m256d stopped = carMask(&cars->flags[i], CAR_STOPPED);
+		__m256d bouncing = carMask(&cars->kind[i], CAR_BOUNCING);
+		__m256d wrapping = carMask(&cars->kind[i], CAR_WRAPPING);
+		__m256d disappearing = carMask(&cars->kind[i], CAR_DISAPPEARING);
+
+		__m256d at_left = _mm256_cmp_pd(_mm256_sub_pd(old_x, step), zero, _CMP_LE_OQ);
+		__m256d at_right = _mm256_cmp_pd(_mm256_add_pd(old_x, step), width, _CMP_GE_OQ);
+		__m256d out_left = _mm256_and_pd(at_left, _mm256_cmp_pd(old_direction, zero, _CMP_LT_OQ));
+		__m256d out_right = _mm256_and_pd(at_right, _mm256_cmp_pd(old_direction, zero, _CMP_GT_OQ));
+
+		//bouncing cars turn around, the left edge wins like the if/else it replaces
+		__m256d bounce_right = _mm256_and_pd(bouncing, at_left);
+		__m256d bounce_left = _mm256_andnot_pd(at_left, _mm256_and_pd(bouncing, at_right));
+		__m256d direction = _mm256_blendv_pd(old_direction, right, bounce_right);
+		direction = _mm256_blendv_pd(direction, left, bounce_left);
+		//wrapping cars jump to the other edge before moving
+		__m256d x = _mm256_blendv_pd(old_x, width, _mm256_and_pd(wrapping, out_left));
+		x = _mm256_blendv_pd(x, zero, _mm256_and_pd(wrapping, out_right));
+		__m256d moved = _mm256_blendv_pd(x, _mm256_add_pd(x, step), _mm256_cmp_pd(direction, zero, _CMP_GT_OQ));
+		moved = _mm256_blendv_pd(moved, _mm256_sub_pd(x, step), _mm256_cmp_pd(direction, zero, _CMP_LT_OQ));
+
+		_mm_storeu_ps(&cars->x[i], _mm256_cvtpd_ps(_mm256_blendv_pd(moved, old_x, stopped)));
+		_mm_storeu_ps(&cars->direction[i], _mm256_cvtpd_ps(_mm256_blendv_pd(direction, old_direction, stopped)));
+
+		__m256d edge = _mm256_or_pd(_mm256_or_pd(bounce_right, bounce_left), _mm256_and_pd(_mm256_or_pd(wrapping, disappearing), _mm256_or_pd(out_left, out_right)));
+		int events = _mm256_movemask_pd(_mm256_andnot_pd(stopped, edge));
+		for (int lane = 0; events != 0; lane++, events >>= 1) {
+			if (events & 1) {
+				carEdgeEvents(cars, i + lane, state);
+			}
+		}
+	}
+	return count;
+}
+
+#elif defined(CAR_KERNEL_SSE2)
+
+inline __m128d carMask(const unsigned char* bytes, int bits) {
+	//2 bytes -> 2 all-ones/all-zeros 64 bit lanes, set where any of bits is set
+	__m128i zero = _mm_setzero_si128();
+	__m128i wide = _mm_cvtsi32_si128(bytes[0] | (bytes[1] << 8));
+	wide = _mm_unpacklo_epi16(_mm_unpacklo_epi8(wide, zero), zero);
+	wide = _mm_shuffle_epi32(wide, _MM_SHUFFLE(1, 1, 0, 0));
+	__m128i set = _mm_and_si128(wide, _mm_set1_epi32(bits));
+	return _mm_castsi128_pd(_mm_cmpgt_epi32(set, zero));
+}
+
+inline __m128d selectPd(__m128d a, __m128d b, __m128d mask) {
+	//b where mask is set, a elsewhere - SSE2 has no blendv
+	return _mm_or_pd(_mm_andnot_pd(mask, a), _mm_and_pd(mask, b));
+}
+
+inline __m128d loadTwo(const float* from) {
+	return _mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64((const __m128i*)from)));
+}
+
+inline void storeTwo(float* to, __m128d value) {
+	_mm_storel_epi64((__m128i*)to, _mm_castps_si128(_mm_cvtpd_ps(value)));
+}
+
+int moveCarsKernel(CarTable* cars, GameState* state) {
+	//2 cars per step in double precision, the same arithmetic the scalar path does
+	//after float -> double promotion, so both paths leave identical positions
+	int count = cars->count & ~1;
+	const __m128d zero = _mm_setzero_pd();
+	const __m128d width = _mm_set1_pd(state->width);
+	const __m128d speed_var = _mm_set1_pd(CAR_SPEED_VAR);
+	const __m128d right = _mm_set1_pd(1.0);
+	const __m128d left = _mm_set1_pd(-1.0);
+	for (int i = 0; i < count; i += 2) {
+		__m128d old_x = loadTwo(&cars->x[i]);
+		__m128d step = _mm_mul_pd(loadTwo(&cars->speed[i]), speed_var);
+		__m128d old_direction = loadTwo(&cars->direction[i]);
+		__m128d stopped = carMask(&cars->flags[i], CAR_STOPPED);
+		__m128d bouncing = carMask(&cars->kind[i], CAR_BOUNCING);
+		__m128d wrapping = carMask(&cars->kind[i], CAR_WRAPPING);
+		__m128d disappearing = carMask(&cars->kind[i], CAR_DISAPPEARING);
+
+		__m128d at_left = _mm_cmple_pd(_mm_sub_pd(old_x, step), zero);
+		__m128d at_right = _mm_cmpge_pd(_mm_add_pd(old_x, step), width);
+		__m128d out_left = _mm_and_pd(at_left, _mm_cmplt_pd(old_direction, zero));
+		__m128d out_right = _mm_and_pd(at_right, _mm_cmpgt_pd(old_direction, zero));
+
+		//bouncing cars turn around, the left edge wins like the if/else it replaces
+		__m128d bounce_right = _mm_and_pd(bouncing, at_left);
+		__m128d bounce_left = _mm_andnot_pd(at_left, _mm_and_pd(bouncing, at_right));
+		__m128d direction = selectPd(old_direction, right, bounce_right);
+		direction = selectPd(direction, left, bounce_left);
+		//wrapping cars jump to the other edge before moving
+		__m128d x = selectPd(old_x, width, _mm_and_pd(wrapping, out_left));
+		x = selectPd(x, zero, _mm_and_pd(wrapping, out_right));
+		__m128d moved = selectPd(x, _mm_add_pd(x, step), _mm_cmpgt_pd(direction, zero));
+		moved = selectPd(moved, _mm_sub_pd(x, step), _mm_cmplt_pd(direction, zero));
+
+		storeTwo(&cars->x[i], selectPd(moved, old_x, stopped));
+		storeTwo(&cars->direction[i], selectPd(direction, old_direction, stopped));
+
+		__m128d edge = _mm_or_pd(_mm_or_pd(bounce_right, bounce_left), _mm_and_pd(_mm_or_pd(wrapping, disappearing), _mm_or_pd(out_left, out_right)));
+		int events = _mm_movemask_pd(_mm_andnot_pd(stopped, edge));
+		for (int lane = 0; events != 0; lane++, events >>= 1) {
+			if (events & 1) {
+				carEdgeEvents(cars, i + lane, state);
+			}
+		}
+	}
+	return count;
+}
+
+#else
+
+int moveCarsKernel(CarTable* cars, GameState* state) {
+	//no vector unit to use, every car takes the scalar path
+	moveCarsScalar(cars, 0, cars->count, state);
+	return cars->count;
+}
+
+#endif
+
+void moveCars(CarTable* cars, GameState* state) {
+	//the kernel takes whole vectors of cars, the scalar path the few left over
+	int done = moveCarsKernel(cars, state);
+	moveCarsScalar(cars, done, cars->count, state);
+}
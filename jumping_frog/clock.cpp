@@ -0,0 +1,82 @@
+#include <chrono>
+#include <math.h>
+#include "clock.h"
+
+//-------------------
+//-------CLOCK-------
+//-------------------
+
+double clockNow() {
+	//monotonic time in seconds, unaffected by wall clock changes
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void initClock(SimClock* clock, double tick_rate, double render_rate, int max_catch_up) {
+	clock->tick_length = 1.0 / tick_rate;
+	clock->render_interval = render_rate > 0 ? 1.0 / render_rate : 0.0;
+	clock->max_catch_up = max_catch_up > 0 ? max_catch_up : 1;
+	clock->accumulator = 0.0;
+	clock->last_time = clockNow();
+	clock->next_render = clock->last_time;
+	clock->ticks = 0;
+	clock->dropped_ticks = 0;
+	clock->ticked = true;
+}
+
+void advanceClock(SimClock* clock) {
+	//move real time into the accumulator, anything past the catch-up limit is dropped
+	//so a long stall (window drag, breakpoint) does not fast-forward the game
+	double now = clockNow();
+	clock->accumulator += now - clock->last_time;
+	clock->last_time = now;
+	double limit = clock->max_catch_up * clock->tick_length;
+	if (clock->accumulator > limit) {
+		clock->dropped_ticks += (long long)((clock->accumulator - limit) / clock->tick_length);
+		clock->accumulator = limit;
+	}
+}
+
+int consumeTick(SimClock* clock) {
+	if (clock->accumulator >= clock->tick_length) {
+		clock->accumulator -= clock->tick_length;
+		clock->ticks++;
+		clock->ticked = true;
+		return true;
+	}
+	return false;
+}
+
+int shouldRender(SimClock* clock) {
+	//nothing changed since the last frame
+	if (!clock->ticked) {
+		return false;
+	}
+	if (clock->render_interval > 0.0) {
+		if (clock->last_time < clock->next_render) {
+			return false;
+		}
+		clock->next_render += clock->render_interval;
+		//fell behind by more than a frame, don't try to render the backlog
+		if (clock->next_render < clock->last_time) {
+			clock->next_render = clock->last_time + clock->render_interval;
+		}
+	}
+	clock->ticked = false;
+	return true;
+}
+
+int msUntilNextEvent(SimClock* clock) {
+	//time left until the next tick or frame is due, whichever comes first
+	double now = clockNow();
+	double until_tick = clock->tick_length - (clock->accumulator + now - clock->last_time);
+	double until_render = clock->next_render - now;
+	double wait = until_tick;
+	if (clock->render_interval > 0.0 && clock->ticked && until_render < wait) {
+		wait = until_render;
+	}
+	if (wait <= 0.0) {
+		return 0;
+	}
+	//rounded up, waking a fraction of a millisecond early would spin until the tick is due
+	return (int)ceil(wait * 1000.0);
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#define DEFAULT_RENDER_RATE		60
+#define DEFAULT_MAX_CATCH_UP	5 // ticks simulated back to back before the clock gives up and drops time
+
+
+
+//-------------------
+//------STRUCTS------
+//-------------------
+typedef struct SimClock {
+	double tick_length = 0.0; // real seconds per simulation tick
+	double render_interval = 0.0; // real seconds between frames, 0 - render every pass
+	int max_catch_up = DEFAULT_MAX_CATCH_UP;
+	double accumulator = 0.0;
+	double last_time = 0.0;
+	double next_render = 0.0;
+	long long ticks = 0;
+	long long dropped_ticks = 0;
+	bool ticked = false; // at least one tick since the last frame
+} SimClock;
+
+
+
+//-------------------
+//----DECLARATIONS---
+//-------------------
+double clockNow();
+void initClock(SimClock* clock, double tick_rate, double render_rate, int max_catch_up);
+void advanceClock(SimClock* clock);
+int consumeTick(SimClock* clock);
+int shouldRender(SimClock* clock);
+int msUntilNextEvent(SimClock* clock);
@@ -0,0 +1,336 @@
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <sys/stat.h>
+#include "config.h"
+
+static const ConfigKey config_keys[] = {
+	{ "frog_color", CONFIG_COLOR, &GameState::frog_color, NULL, 1, 6, 4, CONFIG_LIVE },
+	{ "passive_car_color", CONFIG_COLOR, &GameState::passive_car_color, NULL, 1, 6, 6, CONFIG_LIVE },
+	{ "aggressive_car_color", CONFIG_COLOR, &GameState::aggressive_car_color, NULL, 1, 6, 3, CONFIG_LIVE },
+	{ "friendly_car_color", CONFIG_COLOR, &GameState::friendly_car_color, NULL, 1, 6, 2, CONFIG_LIVE },
+	{ "number_of_bounces", CONFIG_INT, &GameState::number_of_bounces, NULL, 0, 1000, 2, CONFIG_LIVE_SIMULATION },
+	{ "number_of_wraps", CONFIG_INT, &GameState::number_of_wraps, NULL, 0, 1000, 3, CONFIG_LIVE_SIMULATION },
+	{ "frog_symbol", CONFIG_CHAR, NULL, &GameState::frog_symbol, 33, 126, 'O', CONFIG_LIVE },
+	{ "car_symbol", CONFIG_CHAR, NULL, &GameState::car_symbol, 33, 126, '=', CONFIG_LIVE },
+	{ "border_symbol", CONFIG_CHAR, NULL, &GameState::border_symbol, 33, 126, '#', CONFIG_LIVE },
+	{ "lane_separator", CONFIG_CHAR, NULL, &GameState::lane_separator, 33, 126, '-', CONFIG_LIVE },
+	{ "max_time", CONFIG_INT, &GameState::max_time, NULL, 1, 86400, 60, CONFIG_LIVE_SIMULATION },
+	{ "tick_rate", CONFIG_INT, &GameState::tick_rate, NULL, 0, 10000, 0, CONFIG_RESTART },
+	{ "render_rate", CONFIG_INT, &GameState::render_rate, NULL, 1, 1000, DEFAULT_RENDER_RATE, CONFIG_RESTART },
+	{ "max_catch_up", CONFIG_INT, &GameState::max_catch_up, NULL, 1, 1000, DEFAULT_MAX_CATCH_UP, CONFIG_RESTART },
+	{ "seed", CONFIG_INT, &GameState::seed, NULL, 0, 0x7fffffff, 0, CONFIG_RESTART },
+	{ "board_width", CONFIG_INT, &GameState::board_width, NULL, 0, 4096, DEFAULT_BOARD_WIDTH, CONFIG_RESTART },
+	{ "board_height", CONFIG_INT, &GameState::board_height, NULL, 0, 4096, 0, CONFIG_RESTART },
+	{ "lanes", CONFIG_INT, &GameState::lanes, NULL, 1, 2048, DEFAULT_LANES, CONFIG_RESTART },
+	{ "cars_per_lane", CONFIG_INT, &GameState::cars_per_lane, NULL, 1, 256, DEFAULT_CARS_PER_LANE, CONFIG_RESTART },
+	{ "fit_terminal", CONFIG_INT, &GameState::fit_terminal, NULL, 0, 1, 0, CONFIG_RESTART },
+	{ "max_obstacles", CONFIG_INT, &GameState::max_obstacles, NULL, 0, 1000000, 0, CONFIG_RESTART },
+	{ "obstacle_length", CONFIG_INT, &GameState::obstacle_length, NULL, MIN_OBSTACLE_LENGTH, 64, MAX_OBSTACLE_LENGTH, CONFIG_RESTART },
+	{ "obstacle_ramp", CONFIG_INT, &GameState::obstacle_ramp, NULL, 0, 10000, 0, CONFIG_RESTART },
+};
+static const int config_key_count = sizeof(config_keys) / sizeof(config_keys[0]);
+
+// color pairs set up by initColors, 5 is the finish lane
+static const char* color_names[] = { "", "yellow", "blue", "red", "green", "", "white" };
+
+
+
+//-------------------
+//-------KEYS--------
+//-------------------
+
+uint32_t configKeyHash(const char* key, size_t length, uint32_t seed) {
+	uint32_t hash = 2166136261u ^ seed;
+	for (size_t i = 0; i < length; i++) {
+		hash = (hash ^ (unsigned char)key[i]) * 16777619u;
+	}
+	return hash ^ (hash >> 15);
+}
+
+ConfigHash buildConfigHash() {
+	//try seeds until every key gets a slot of its own, then a lookup is one hash and one compare
+	ConfigHash table;
+	for (uint32_t seed = 0;; seed++) {
+		memset(table.slots, -1, sizeof(table.slots));
+		table.seed = seed;
+		int i = 0;
+		for (; i < config_key_count; i++) {
+			uint32_t slot = configKeyHash(config_keys[i].name, strlen(config_keys[i].name), seed) & (CONFIG_HASH_SLOTS - 1);
+			if (table.slots[slot] != -1) {
+				break;
+			}
+			table.slots[slot] = (signed char)i;
+		}
+		if (i == config_key_count) {
+			return table;
+		}
+	}
+}
+
+int findConfigKey(const char* key, size_t length) {
+	//built on first use, static initialization is thread safe
+	static const ConfigHash table = buildConfigHash();
+	int index = table.slots[configKeyHash(key, length, table.seed) & (CONFIG_HASH_SLOTS - 1)];
+	if (index < 0 || strlen(config_keys[index].name) != length || memcmp(config_keys[index].name, key, length) != 0) {
+		return -1;
+	}
+	return index;
+}
+
+void applyConfigDefaults(GameState* state) {
+	for (int i = 0; i < config_key_count; i++) {
+		storeConfigValue(&config_keys[i], state, config_keys[i].fallback);
+	}
+}
+
+
+
+//-------------------
+//------PARSING------
+//-------------------
+
+int parseConfigInt(const char* value, size_t length, int* result) {
+	size_t at = 0;
+	bool negative = false;
+	if (at < length && (value[at] == '-' || value[at] == '+')) {
+		negative = value[at] == '-';
+		at++;
+	}
+	if (at == length) {
+		return false;
+	}
+	long long number = 0;
+	for (; at < length; at++) {
+		if (value[at] < '0' || value[at] > '9' || number > 0x7fffffff) {
+			return false;
+		}
+		number = number * 10 + (value[at] - '0');
+	}
+	number = negative ? -number : number;
+	if (number > 0x7fffffff || number < -0x7fffffffll - 1) {
+		return false;
+	}
+	*result = (int)number;
+	return true;
+}
+
+int parseConfigValue(const ConfigKey* key, const char* value, size_t length, int* result) {
+	switch (key->type) {
+	case CONFIG_INT:
+		if (!parseConfigInt(value, length, result)) {
+			return CONFIG_BAD_VALUE;
+		}
+		break;
+	case CONFIG_CHAR:
+		if (length != 1) {
+			return CONFIG_BAD_VALUE;
+		}
+		*result = (unsigned char)value[0];
+		break;
+	case CONFIG_COLOR:
+		if (!parseConfigInt(value, length, result)) {
+			*result = -1;
+			for (int i = 0; i < (int)(sizeof(color_names) / sizeof(color_names[0])); i++) {
+				size_t name_length = strlen(color_names[i]);
+				bool same = name_length == length && name_length > 0;
+				for (size_t j = 0; same && j < length; j++) {
+					same = tolower((unsigned char)value[j]) == color_names[i][j];
+				}
+				if (same) {
+					*result = i;
+				}
+			}
+			if (*result < 0) {
+				return CONFIG_BAD_VALUE;
+			}
+		}
+		break;
+	}
+	if (*result < key->min || *result > key->max) {
+		return CONFIG_OUT_OF_RANGE;
+	}
+	return CONFIG_OK;
+}
+
+void storeConfigValue(const ConfigKey* key, GameState* state, int value) {
+	if (key->int_field != NULL) {
+		state->*key->int_field = value;
+	}
+	else {
+		state->*key->char_field = (char)value;
+	}
+}
+
+int loadConfigValue(const ConfigKey* key, GameState* state) {
+	return key->int_field != NULL ? state->*key->int_field : (unsigned char)(state->*key->char_field);
+}
+
+int setConfigValue(const char* key, size_t key_length, const char* value, size_t value_length, GameState* state, bool live_only, ConfigReport* report) {
+	//a rejected value falls back to the key's default on a full read, a reload keeps what is there
+	int index = findConfigKey(key, key_length);
+	if (index < 0) {
+		return CONFIG_UNKNOWN_KEY;
+	}
+	const ConfigKey* entry = &config_keys[index];
+	int result = 0;
+	int status = parseConfigValue(entry, value, value_length, &result);
+	if (live_only && entry->live == CONFIG_RESTART) {
+		//startup values like the seed or the board size may have been resolved since, leave them be
+		return CONFIG_OK;
+	}
+	if (status != CONFIG_OK) {
+		if (!live_only) {
+			storeConfigValue(entry, state, entry->fallback);
+		}
+		return status;
+	}
+	if (report != NULL) {
+		if (entry->live == CONFIG_LIVE_SIMULATION && loadConfigValue(entry, state) != result) {
+			report->simulation_changed = true;
+		}
+		report->applied++;
+	}
+	storeConfigValue(entry, state, result);
+	return CONFIG_OK;
+}
+
+void reportConfigError(ConfigReport* report, int line, const char* key, size_t key_length, int status) {
+	static const char* reasons[] = { "ok", "unknown key", "bad value", "value out of range" };
+	if (report == NULL) {
+		return;
+	}
+	if (report->errors == 0) {
+		snprintf(report->message, sizeof(report->message), "line %d: %.*s: %s", line, (int)key_length, key, reasons[status]);
+	}
+	report->errors++;
+}
+
+void parseConfigText(const char* text, size_t length, GameState* state, bool live_only, ConfigReport* report) {
+	//key=value per line, spaces around both are ignored, the text is never copied
+	size_t at = 0;
+	int line = 0;
+	while (at < length) {
+		line++;
+		size_t end = at;
+		while (end < length && text[end] != '\n') {
+			end++;
+		}
+		size_t key = at;
+		while (key < end && isspace((unsigned char)text[key])) {
+			key++;
+		}
+		size_t equals = key;
+		while (equals < end && text[equals] != '=') {
+			equals++;
+		}
+		if (equals < end) {
+			size_t key_end = equals;
+			while (key_end > key && isspace((unsigned char)text[key_end - 1])) {
+				key_end--;
+			}
+			size_t value = equals + 1;
+			size_t value_end = end;
+			while (value < value_end && isspace((unsigned char)text[value])) {
+				value++;
+			}
+			while (value_end > value && isspace((unsigned char)text[value_end - 1])) {
+				value_end--;
+			}
+			int status = setConfigValue(&text[key], key_end - key, &text[value], value_end - value, state, live_only, report);
+			if (status != CONFIG_OK) {
+				reportConfigError(report, line, &text[key], key_end - key, status);
+			}
+		}
+		at = end + 1;
+	}
+}
+
+int readConfigFile(const char* filename, GameState* state, ConfigReport* report) {
+	//every key starts at its default, so a missing file or key still gives a playable game
+	applyConfigDefaults(state);
+	FILE* file = fopen(filename, "rb");
+	if (file == NULL) {
+		if (report != NULL) {
+			snprintf(report->message, sizeof(report->message), "cannot open %s, using defaults", filename);
+			report->errors++;
+		}
+		return false;
+	}
+	char text[CONFIG_MAX_BYTES];
+	size_t length = fread(text, 1, sizeof(text), file);
+	bool truncated = length == sizeof(text) && fgetc(file) != EOF;
+	fclose(file);
+	parseConfigText(text, length, state, false, report);
+	if (truncated && report != NULL && report->errors++ == 0) {
+		snprintf(report->message, sizeof(report->message), "%s is longer than %d bytes, the rest is ignored", filename, CONFIG_MAX_BYTES);
+	}
+	return true;
+}
+
+
+
+//-------------------
+//------RELOAD-------
+//-------------------
+
+long long configStamp(const char* filename) {
+	//modification time and size, an edit within the same second usually changes the size
+	struct stat info;
+	if (stat(filename, &info) != 0) {
+		return -1;
+	}
+	return (long long)info.st_mtime * 1000003 + (long long)info.st_size;
+}
+
+void initConfigWatch(ConfigWatch* watch, const char* filename, double now) {
+	watch->filename = filename;
+	watch->stamp = configStamp(filename);
+	watch->next_check = now + CONFIG_POLL_SECONDS;
+}
+
+int configChanged(ConfigWatch* watch, double now) {
+	if (now < watch->next_check) {
+		return false;
+	}
+	watch->next_check = now + CONFIG_POLL_SECONDS;
+	long long stamp = configStamp(watch->filename);
+	if (stamp == watch->stamp || stamp < 0) {
+		return false;
+	}
+	watch->stamp = stamp;
+	return true;
+}
+
+void applyLiveConfig(GameState* state, CarTable* cars) {
+	//cars and the map keep the symbols and colors they were given, so hand them the new ones
+	for (int i = 0; i < cars->count; i++) {
+		if (cars->symbol[i] != ' ') {
+			cars->symbol[i] = state->car_symbol;
+		}
+		cars->color[i] = cars->kind[i] & CAR_PASSIVE ? state->passive_car_color :
+			cars->kind[i] & CAR_AGGRESSIVE ? state->aggressive_car_color :
+			cars->kind[i] & CAR_FRIENDLY ? state->friendly_car_color : cars->color[i];
+	}
+	//the file holds the plain symbol, a frog waiting for a pick-up keeps showing it lowercase
+	setFrogSymbol(state, state->frog_symbol);
+	if (state->obstaclesSet) {
+		setBordersAndSeparators(state);
+		obstaclesToArray(state);
+		setFinishLane(state);
+	}
+}
+
+int reloadConfig(const char* filename, GameState* state, CarTable* cars, ConfigReport* report) {
+	//only the live keys are read, a missing or half written file changes nothing
+	FILE* file = fopen(filename, "rb");
+	if (file == NULL) {
+		return false;
+	}
+	char text[CONFIG_MAX_BYTES];
+	size_t length = fread(text, 1, sizeof(text), file);
+	fclose(file);
+	parseConfigText(text, length, state, true, report);
+	applyLiveConfig(state, cars);
+	return true;
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include <stdint.h>
+#include "game.h"
+
+#define CONFIG_FILE				"config.txt"
+#define CONFIG_MAX_BYTES		16384 // longest config file read, it is parsed in place
+#define CONFIG_HASH_SLOTS		64 // power of two, more than twice the number of keys
+#define CONFIG_POLL_SECONDS		1.0 // how often the game looks at the file for changes
+#define CONFIG_MESSAGE_SIZE		160
+
+// when a key takes effect
+#define CONFIG_RESTART			0 // only read at startup
+#define CONFIG_LIVE				1 // hot reloaded, only changes how the game looks
+#define CONFIG_LIVE_SIMULATION	2 // hot reloaded, changes how the game plays out
+
+
+
+//-------------------
+//------STRUCTS------
+//-------------------
+typedef enum ConfigType {
+	CONFIG_INT,
+	CONFIG_CHAR, // one printable character
+	CONFIG_COLOR // a color pair number or its name
+} ConfigType;
+
+typedef enum ConfigStatus {
+	CONFIG_OK,
+	CONFIG_UNKNOWN_KEY,
+	CONFIG_BAD_VALUE, // not a number, not a color, empty...
+	CONFIG_OUT_OF_RANGE
+} ConfigStatus;
+
+// one config.txt key, the value goes into the int or the char field of GameState
+typedef struct ConfigKey {
+	const char* name;
+	ConfigType type;
+	int GameState::* int_field;
+	char GameState::* char_field;
+	int min;
+	int max;
+	int fallback; // used when the key is missing or its value is rejected
+	int live; // CONFIG_RESTART, CONFIG_LIVE or CONFIG_LIVE_SIMULATION
+} ConfigKey;
+
+// key name -> index into the key table without comparing against every key
+typedef struct ConfigHash {
+	uint32_t seed = 0;
+	signed char slots[CONFIG_HASH_SLOTS]; // -1 - empty
+} ConfigHash;
+
+typedef struct ConfigReport {
+	int applied = 0;
+	int errors = 0;
+	bool simulation_changed = false; // a reload changed a CONFIG_LIVE_SIMULATION value
+	char message[CONFIG_MESSAGE_SIZE] = ""; // the first error
+} ConfigReport;
+
+// notices edits to the config file by polling its modification time and size
+typedef struct ConfigWatch {
+	const char* filename = CONFIG_FILE;
+	long long stamp = -1;
+	double next_check = 0;
+} ConfigWatch;
+
+
+
+//-------------------
+//----DECLARATIONS---
+//-------------------
+
+// Key functions
+uint32_t configKeyHash(const char* key, size_t length, uint32_t seed);
+ConfigHash buildConfigHash();
+int findConfigKey(const char* key, size_t length);
+void applyConfigDefaults(GameState* state);
+
+// Parsing functions
+int parseConfigInt(const char* value, size_t length, int* result);
+int parseConfigValue(const ConfigKey* key, const char* value, size_t length, int* result);
+void storeConfigValue(const ConfigKey* key, GameState* state, int value);
+int loadConfigValue(const ConfigKey* key, GameState* state);
+int setConfigValue(const char* key, size_t key_length, const char* value, size_t value_length, GameState* state, bool live_only, ConfigReport* report);
+void reportConfigError(ConfigReport* report, int line, const char* key, size_t key_length, int status);
+void parseConfigText(const char* text, size_t length, GameState* state, bool live_only, ConfigReport* report);
+int readConfigFile(const char* filename, GameState* state, ConfigReport* report);
+
+// Reload functions
+long long configStamp(const char* filename);
+void initConfigWatch(ConfigWatch* watch, const char* filename, double now);
+int configChanged(ConfigWatch* watch, double now);
+void applyLiveConfig(GameState* state, CarTable* cars);
+int reloadConfig(const char* filename, GameState* state, CarTable* cars, ConfigReport* report);
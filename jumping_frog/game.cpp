@@ -0,0 +1,505 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+#include "game.h"
+#include "levels.h"
+
+//-------------------
+//--------MAP--------
+//-------------------
+
+void initBoard(GameState* state) {
+	//size the board from the config, every grid is one contiguous block of width * height cells
+	if (state->board_height > 0) {
+		state->lanes = (state->board_height - BOARD_EXTRA_ROWS) / 2;
+	}
+	if (state->lanes < 1) {
+		state->lanes = 1;
+	}
+	if (state->cars_per_lane < 1) {
+		state->cars_per_lane = 1;
+	}
+	state->width = state->board_width > MIN_BOARD_WIDTH ? state->board_width : MIN_BOARD_WIDTH;
+	state->height = state->lanes * 2 + BOARD_EXTRA_ROWS;
+	state->car_count = state->lanes * state->cars_per_lane;
+	//keep the obstacle density of the default board
+	state->obstacle_count = MAX_OBSTACLES * state->width * state->lanes / (DEFAULT_BOARD_WIDTH * DEFAULT_LANES);
+	if (state->max_obstacles > 0) {
+		state->obstacle_count = state->max_obstacles;
+	}
+	if (state->obstacle_count < 1) {
+		state->obstacle_count = 1;
+	}
+	state->map.assign(state->width * state->height, ' ');
+	state->row_words = (state->width + 63) / 64;
+	state->obstacles.assign(state->height * state->row_words, 0);
+	state->obstaclesSet = false;
+	state->frog_y = state->height - 2;
+	state->frog_x = state->width / 2;
+
+	initCarIndex(state);
+}
+
+int obstacleAt(GameState* state, int y, int x) {
+	return (int)(state->obstacles[y * state->row_words + (x >> 6)] >> (x & 63)) & 1;
+}
+
+void setObstacleRun(GameState* state, int y, int x, int n) {
+	placeRun(&state->obstacles[y * state->row_words], x, n);
+}
+
+void setObstacles(GameState* state) {
+	//layouts come from the level generator, this round's one is usually built already
+	if (state->obstaclesSet == false) {
+		takeLevel(state);
+		state->obstaclesSet = true;
+	}
+}
+
+void obstaclesToArray(GameState* state) {
+	//set obstacles and put them on the map array
+	setObstacles(state);
+	for (int y = 2; y < state->height - 2; y += 2) {
+		for (int x = 1; x < state->width - 1; x++) {
+			if (obstacleAt(state, y, x)) {
+				state->map[y * state->width + x] = OBSTACLE_SYMBOL;
+			}
+		}
+	}
+}
+
+void setBordersAndSeparators(GameState* state) {
+	//put these objects on the map array:
+	//-top border
+	//-bottom border
+	//-lane separators
+	int width = state->width;
+	for (int i = 0; i < width; i++) {
+		for (int j = 2; j < state->height; j++) {
+			if (j % 2 == 0) {
+				state->map[j * width + i] = state->lane_separator;
+			}
+		}
+		state->map[i] = state->border_symbol;
+		state->map[(state->height - 1) * width + i] = state->border_symbol;
+	}
+	//put side borders on the map array
+	for (int i = 0; i < state->height; i++) {
+		state->map[i * width] = state->border_symbol;
+		state->map[i * width + width - 1] = state->border_symbol;
+	}
+}
+
+void setFinishLane(GameState* state) {
+	for (int i = 1; i < state->width - 1; i++) {
+		state->map[state->width + i] = FINISH_LANE_SYMBOL;
+	}
+}
+
+void buildMap(GameState* state) {
+	//the map only changes when a new round lays out new obstacles
+	if (state->obstaclesSet) {
+		return;
+	}
+	setBordersAndSeparators(state);
+	obstaclesToArray(state);
+	setFinishLane(state);
+	state->layout++;
+}
+
+
+
+//-------------------
+//-------FROG--------
+//-------------------
+
+void checkForObstacle(GameState* state) {
+	int y = state->frog_y;
+	int x = state->frog_x;
+	if (obstacleAt(state, y - 1, x)) {
+		state->moveUp = false;
+	}
+	if (obstacleAt(state, y + 1, x)) {
+		state->moveDown = false;
+	}
+	if (obstacleAt(state, y, x - 1)) {
+		state->moveLeft = false;
+	}
+	if (obstacleAt(state, y, x + 1)) {
+		state->moveRight = false;
+	}
+}
+
+void setAllMovementTrue(GameState* state) {
+	state->moveLeft = true;
+	state->moveRight = true;
+	state->moveUp = true;
+	state->moveDown = true;
+}
+
+int frogRideOff(GameState* state, CarTable* cars) {
+	//only cars the last collision check left carrying the frog can be ridden off
+	CarIndex* index = &state->car_index;
+	for (int k = 0; k < index->rider_count; k++) {
+		int i = index->riders[k];
+		if (!obstacleAt(state, state->frog_y, state->frog_x) && (cars->flags[i] & CAR_RIDDEN)) {
+			cars->flags[i] &= ~CAR_RIDDEN;
+			return true;
+		}
+	}
+	return false;
+}
+
+void upCase(GameState* state) {
+	if (state->frog_y > 1 && state->moveUp) {
+		state->frog_y -= 1;
+		state->inputDetected = true;
+		state->save_timer = state->input_time;
+	}
+}
+
+void downCase(GameState* state) {
+	if (state->frog_y < state->height - FROG_HEIGHT - 1 && state->moveDown) {
+		state->frog_y += 1;
+		state->inputDetected = true;
+		state->save_timer = state->input_time;
+	}
+}
+
+void leftCase(GameState* state) {
+	if (state->frog_x > 2 && state->moveLeft) {
+		state->frog_x -= 1;
+		state->inputDetected = true;
+		state->save_timer = state->input_time;
+	}
+}
+
+void rightCase(GameState* state) {
+	if (state->frog_x < state->width - FROG_WIDTH - 1 && state->moveRight) {
+		state->frog_x += 1;
+		state->inputDetected = true;
+		state->save_timer = state->input_time;
+	}
+}
+
+void setFrogSymbol(GameState* state, char symbol) {
+	//a lowercase frog is waiting to be picked up by a friendly car
+	state->frog_symbol = state->awaiting ? tolower(symbol) : toupper(symbol);
+}
+
+void awaitingPickUp(GameState* state) {
+	if (state->move == INPUT_PICK_UP) {
+		state->awaiting = !state->awaiting;
+		setFrogSymbol(state, state->frog_symbol);
+	}
+}
+
+void applyInput(GameState* state, CarTable* cars, const InputEvent* input) {
+	//the jump delay is measured from when each key was pressed, not from the tick it landed in
+	state->input_time = input->time >= 0 ? input->time : state->timer;
+	letAnotherDetect(state);
+	state->move = input->action;
+	awaitingPickUp(state);
+	//quitting is not a jump, it must not wait out the jump delay
+	if (state->move == INPUT_QUIT) {
+		state->quit = 0;
+	}
+	if (state->inputDetected == false && state->awaiting == false) {
+		switch (state->move) {
+		case INPUT_UP:
+			if (frogRideOff(state, cars)) {
+				break;
+			}
+			upCase(state);
+			break;
+		case INPUT_DOWN:
+			if (frogRideOff(state, cars)) {
+				break;
+			}
+			downCase(state);
+			break;
+		case INPUT_LEFT:
+			if (frogRideOff(state, cars)) {
+				break;
+			}
+			leftCase(state);
+			break;
+		case INPUT_RIGHT:
+			if (frogRideOff(state, cars)) {
+				break;
+			}
+			rightCase(state);
+			break;
+		case INPUT_SKIP:
+			state->timer = state->max_time + 1;
+			break;
+		}
+	}
+}
+
+void letAnotherDetect(GameState* state) {
+	if (state->input_time - state->save_timer > DELAY_AFTER_JUMP) {
+		state->inputDetected = false;
+	}
+}
+
+void ifScored(GameState* state) {
+	if (state->frog_y == 1) {
+		state->points += 10;
+		state->crossings++;
+		state->frog_y = state->height - 2;
+		state->frog_x = state->width / 2;
+	}
+}
+
+
+
+//-------------------
+//-------CARS--------
+//-------------------
+
+void typeChoiceCase(int choice, int n, CarTable* cars, unsigned char type, int i) {
+	if (choice == n) {
+		cars->kind[i] = (cars->kind[i] & ~(CAR_WRAPPING | CAR_BOUNCING | CAR_DISAPPEARING)) | type;
+	}
+}
+
+void interactionChoiceCase(int choice, int n, CarTable* cars, unsigned char interaction, int i, int color) {
+	if (choice == n) {
+		cars->kind[i] = (cars->kind[i] & ~(CAR_PASSIVE | CAR_AGGRESSIVE | CAR_FRIENDLY)) | interaction;
+		cars->color[i] = color;
+	}
+}
+
+void carDirection(int i, CarTable* cars, GameState* state) {
+	//cars sharing a lane start spread evenly along it
+	int lane = i / state->cars_per_lane;
+	int offset = (i % state->cars_per_lane) * state->width / state->cars_per_lane;
+	if (lane % 2) { // nieparzyste go right
+		cars->x[i] = 2 + offset;
+		cars->direction[i] = 1;
+	}
+	else if (!(lane % 2)) { //parzyste go left
+		cars->x[i] = state->width - 2 - offset;
+		cars->direction[i] = -1;
+	}
+}
+
+void initializeCars(CarTable* cars, GameState* state) {
+	for (int i = 0; i < state->car_count; i++) {
+		if (!(cars->flags[i] & CAR_INITIALIZED)) {
+
+			int speed_choice = randomBelow(&state->rng, 3) + 1;
+			int type_choice = randomBelow(&state->rng, 3) + 1;
+			int interaction_choice = randomBelow(&state->rng, 3) + 1;
+
+			cars->y[i] = (i / state->cars_per_lane) * 2 + 3;
+
+			carDirection(i, cars, state);
+
+			typeChoiceCase(type_choice, 1, cars, CAR_WRAPPING, i);
+			typeChoiceCase(type_choice, 2, cars, CAR_BOUNCING, i);
+			typeChoiceCase(type_choice, 3, cars, CAR_DISAPPEARING, i);
+
+			interactionChoiceCase(interaction_choice, 1, cars, CAR_PASSIVE, i, state->passive_car_color);
+			interactionChoiceCase(interaction_choice, 2, cars, CAR_AGGRESSIVE, i, state->aggressive_car_color);
+			interactionChoiceCase(interaction_choice, 3, cars, CAR_FRIENDLY, i, state->friendly_car_color);
+
+			cars->speed[i] = speed_choice;
+			cars->symbol[i] = state->car_symbol;
+			cars->iters[i] = 0;
+			cars->flags[i] |= CAR_INITIALIZED;
+		}
+	}
+}
+
+void changeCarAfterNumOfIters(int iterations, CarTable* cars, int i) {
+	if (cars->iters[i] > iterations) {
+		cars->iters[i] = 0;
+		cars->flags[i] &= ~CAR_INITIALIZED;
+	}
+}
+
+void bounceCar(CarTable* cars, int i, GameState* state) {
+	if (cars->kind[i] & CAR_BOUNCING) {
+		if (cars->x[i] - cars->speed[i] * CAR_SPEED_VAR <= 0) {
+			cars->iters[i]++;
+			changeCarAfterNumOfIters(state->number_of_bounces, cars, i);
+			cars->direction[i] = 1;
+		}
+		else if (cars->x[i] + cars->speed[i] * CAR_SPEED_VAR >= state->width) {
+			cars->iters[i]++;
+			changeCarAfterNumOfIters(state->number_of_bounces, cars, i);
+			cars->direction[i] = -1;
+		}
+	}
+}
+
+void wrapCar(CarTable* cars, int i, GameState* state) {
+	if (cars->kind[i] & CAR_WRAPPING) {
+		if (cars->x[i] - cars->speed[i] * CAR_SPEED_VAR <= 0 && cars->direction[i] < 0) {
+			cars->iters[i]++;
+			changeCarAfterNumOfIters(state->number_of_wraps, cars, i);
+			cars->x[i] = state->width;
+		}
+		else if (cars->x[i] + cars->speed[i] * CAR_SPEED_VAR >= state->width && cars->direction[i] > 0) {
+			cars->iters[i]++;
+			changeCarAfterNumOfIters(state->number_of_wraps, cars, i);
+			cars->x[i] = 0;
+		}
+	}
+}
+
+void disappearCar(CarTable* cars, int i, GameState* state) {
+	//a disappearing car drops the frog it was carrying and gets re-rolled next tick
+	if (cars->kind[i] & CAR_DISAPPEARING) {
+		if ((cars->x[i] - cars->speed[i] * CAR_SPEED_VAR <= 0 && cars->direction[i] < 0) || (cars->x[i] + cars->speed[i] * CAR_SPEED_VAR >= state->width && cars->direction[i] > 0)) {
+			cars->flags[i] &= ~(CAR_RIDDEN | CAR_INITIALIZED);
+		}
+	}
+}
+
+void aggressiveCase(int i, CarTable* cars, GameState* state) {
+	if (cars->kind[i] & CAR_AGGRESSIVE) {
+		state->collisionDetected++;
+		state->points -= 5;
+		state->frog_y = state->height - 2;
+		state->frog_x = state->width / 2;
+	}
+}
+
+void passiveCase(int i, CarTable* cars, GameState* state) {
+	if (cars->kind[i] & CAR_PASSIVE) {
+		cars->flags[i] |= CAR_STOPPED;
+	}
+}
+
+void friendlyCase(int i, CarTable* cars, GameState* state) {
+	if ((cars->kind[i] & CAR_FRIENDLY) && !state->awaiting) {
+		cars->flags[i] |= CAR_STOPPED;
+	}
+	else if ((cars->kind[i] & CAR_FRIENDLY) && state->awaiting) {
+		cars->flags[i] = (cars->flags[i] & ~CAR_STOPPED) | CAR_RIDDEN;
+		state->frog_x = cars->x[i];
+		state->frog_y = cars->y[i];
+	}
+}
+
+void hits(int i, CarTable* cars, GameState* state) {
+	float car_x = cars->x[i];
+	int car_y = cars->y[i];
+	if ((state->frog_x <= car_x + state->r) &&
+		(state->frog_x >= car_x - state->r) &&
+		(state->frog_y == car_y)) {
+		aggressiveCase(i, cars, state);
+		passiveCase(i, cars, state);
+		friendlyCase(i, cars, state);
+	}
+	else if ((((car_x <= state->frog_x + CAR_BRAKE_DISTANCE) &&
+		(car_x >= state->frog_x) &&
+		(car_y == state->frog_y)) &&
+		(cars->direction[i] < 0)) ||
+		(((car_x >= state->frog_x - CAR_BRAKE_DISTANCE) &&
+			(car_x <= state->frog_x) &&
+			(car_y == state->frog_y)) &&
+			(cars->direction[i] > 0))) {
+		passiveCase(i, cars, state);
+		friendlyCase(i, cars, state);
+	}
+	else if ((((state->frog_x <= car_x + state->r) &&
+		(state->frog_x >= car_x - state->r) &&
+		(state->frog_y == car_y)) &&
+		(state->awaiting == true)) ||
+		(cars->flags[i] & CAR_RIDDEN)) {
+		friendlyCase(i, cars, state);
+	}
+	else {
+		cars->flags[i] &= ~CAR_STOPPED;
+	}
+}
+
+
+
+//-------------------
+//-------GAME--------
+//-------------------
+
+void changeOfSpeed(GameState* state, CarTable* cars) {
+	if (((int)state->timer % SPEED_CHANGE_INTERVAL) == 0 && state->timer != 0) {
+		for (int i = 0; i < state->car_count; i++) {
+			int speed_choice = randomBelow(&state->rng, 3) + 1;
+			cars->speed[i] = speed_choice;
+		}
+	}
+}
+
+void setNewHighscore(GameState* state) {
+	if (state->highscore < state->points) {
+		state->highscore = state->points;
+	}
+}
+
+void resetVariables(GameState* state, CarTable* cars) {
+	state->map.assign(state->map.size(), ' ');
+	state->obstacles.assign(state->obstacles.size(), 0);
+	state->obstaclesSet = false;
+	state->frog_y = state->height - 2;
+	state->frog_x = state->width / 2;
+	state->timer = 0;
+	state->points = 0;
+	state->crossings = 0;
+	state->r = CAR_SPEED_VAR + 1;
+	state->collisionDetected = 0;
+	state->moveLeft = true;
+	state->moveRight = true;
+	state->moveUp = true;
+	state->moveDown = true;
+	for (int i = 0; i < state->car_count; i++) {
+		cars->flags[i] &= ~(CAR_RIDDEN | CAR_INITIALIZED);
+	}
+	state->car_index.rider_count = 0;
+}
+
+void resetGame(GameState* state, CarTable* cars) {
+	if (state->timer > state->max_time) {
+		setNewHighscore(state);
+		resetVariables(state, cars);
+	}
+}
+
+void noNegativeScore(GameState* state) {
+	if (state->points < 0) {
+		state->points = 0;
+	}
+}
+
+void seedGame(GameState* state) {
+	//keep the seed that was used so the run can be repeated with seed=<value>
+	if (state->seed == 0) {
+		state->seed = (int)(time(NULL) & 0x7fffffff);
+	}
+	seedRng(&state->rng, (uint64_t)state->seed);
+}
+
+void stepGame(GameState* state, CarTable* cars, const InputEvent* inputs, int count) {
+	//one fixed tick of the game, TIMER_ADDITION seconds long, applying every key
+	//pressed since the previous tick in the order they came in
+	buildMap(state);
+	state->timer += TIMER_ADDITION;
+	for (int i = 0; i < count; i++) {
+		setAllMovementTrue(state);
+		checkForObstacle(state);
+		applyInput(state, cars, &inputs[i]);
+	}
+	state->input_time = state->timer;
+	letAnotherDetect(state);
+	ifScored(state);
+	initializeCars(cars, state);
+	changeOfSpeed(state, cars);
+	moveCars(cars, state);
+	collisionDetect(cars, state);
+	noNegativeScore(state);
+	resetGame(state, cars);
+}
@@ -0,0 +1,213 @@
+#pragma once
+#include <vector>
+#include "clock.h"
+#include "rng.h"
+
+#define DEFAULT_BOARD_WIDTH		41
+#define DEFAULT_LANES			5
+#define DEFAULT_CARS_PER_LANE	1
+#define MIN_BOARD_WIDTH			36 // narrowest board the info line still fits on
+#define BOARD_EXTRA_ROWS		5 // borders, finish lane, start lane and the separator above it
+#define FROG_HEIGHT				1
+#define FROG_WIDTH				1
+#define CAR_SPEED_VAR			0.05
+#define MAX_OBSTACLES			5
+#define MIN_OBSTACLE_LENGTH		3
+#define MAX_OBSTACLE_LENGTH		10
+#define OBSTACLE_SYMBOL			'@'
+#define FINISH_LANE_SYMBOL		'_'
+#define SPEED_CHANGE_INTERVAL	5
+#define CAR_BRAKE_DISTANCE		4 // passive and friendly cars stop for a frog this many cells ahead
+
+// CarTable kind bits
+#define CAR_WRAPPING			0x01
+#define CAR_BOUNCING			0x02
+#define CAR_DISAPPEARING		0x04
+#define CAR_PASSIVE				0x08
+#define CAR_AGGRESSIVE			0x10
+#define CAR_FRIENDLY			0x20
+
+// CarTable flags bits
+#define CAR_INITIALIZED			0x01
+#define CAR_STOPPED				0x02 // stopped for the frog, moveCars leaves it where it is
+#define CAR_RIDDEN				0x04 // carrying the frog
+
+#define TIMER_ADDITION			0.015 // game seconds simulated per tick
+#define DEFAULT_TICK_RATE		(1.0 / TIMER_ADDITION) // ticks per real second
+#define DELAY_AFTER_JUMP		0.3 // 0.3 for visible delay but still playable --- no delay seems more comfortable though
+
+
+
+//-------------------
+//------STRUCTS------
+//-------------------
+// cars grouped by lane, so collision checks only look at the frog's lane
+// every array is sized once by initBoard, per tick work never allocates
+typedef struct CarIndex {
+	std::vector<int> lane_start; // cars of lane y are ids [lane_start[y], lane_start[y + 1])
+	std::vector<int> stopped; // cars with stopCar set by the last check
+	int stopped_count = 0;
+	std::vector<int> riders; // cars with frogRide set
+	int rider_count = 0;
+	std::vector<int> candidates; // collision check scratch, 3 * car_count
+} CarIndex;
+
+typedef struct GameState {
+	int quit = 1;
+	int frog_y = 0;
+	int frog_x = 0;
+	int frog_color = 0;
+	int move = 0;
+	int board_width = DEFAULT_BOARD_WIDTH;
+	int board_height = 0; // 0 - taken from lanes
+	int lanes = DEFAULT_LANES;
+	int cars_per_lane = DEFAULT_CARS_PER_LANE;
+	int fit_terminal = 0; // 1 - board_width and lanes follow the terminal size
+	int max_obstacles = 0; // obstacles on the first level, 0 - scaled with the board
+	int obstacle_length = MAX_OBSTACLE_LENGTH; // longest obstacle run
+	int obstacle_ramp = 0; // obstacles added every level
+	int width = 0; // board size in cells, set by initBoard
+	int height = 0;
+	int car_count = 0;
+	int obstacle_count = 0;
+	std::vector<char> map; // height rows of width cells, row y starts at y * width
+	std::vector<uint64_t> obstacles; // one bit per cell, row y is row_words words from y * row_words
+	int row_words = 0;
+	float timer = 0;
+	int points = 0;
+	int r = CAR_SPEED_VAR + 1;
+	int collisionDetected = 0;
+	char frog_symbol = ' ';
+	char car_symbol = ' ';
+	int car_speed_variable = 0;
+	int passive_car_color = 0;
+	int aggressive_car_color = 0;
+	int friendly_car_color = 0;
+	char border_symbol = ' ';
+	char lane_separator = ' ';
+	int max_time = 0;
+	int number_of_bounces = 0;
+	int number_of_wraps = 0;
+	bool moveLeft = true;
+	bool moveRight = true;
+	bool moveUp = true;
+	bool moveDown = true;
+	bool obstaclesSet = false;
+	int highscore = 0;
+	bool wDetected = false;
+	bool aDetected = false;
+	bool sDetected = false;
+	bool dDetected = false;
+	bool inputDetected = false;
+	float save_timer;
+	float input_time = 0; // game time of the input being applied
+	bool awaiting = false;
+	int tick_rate = 0; // 0 - DEFAULT_TICK_RATE
+	int render_rate = DEFAULT_RENDER_RATE;
+	int max_catch_up = DEFAULT_MAX_CATCH_UP;
+	int crossings = 0; // times the frog reached the finish lane this round
+	int seed = 0; // 0 - seeded from the clock
+	int layout = 0; // bumped every time buildMap lays out a new map
+	CarIndex car_index;
+	Rng rng;
+	struct LevelCache* levels = nullptr; // layouts built ahead, nullptr - each one built when needed
+} state;
+
+// one array per field, car i is element i of each, so moveCars can load
+// several cars' positions with one instruction
+typedef struct CarTable {
+	int count = 0;
+	std::vector<float> x;
+	std::vector<float> speed;
+	std::vector<float> direction; // 1 - right, -1 - left, 0 - not initialized
+	std::vector<int> y;
+	std::vector<int> iters; // bounces or wraps since the car was initialized
+	std::vector<int> color;
+	std::vector<char> symbol;
+	std::vector<unsigned char> kind; // one CAR_* type bit and one CAR_* interaction bit
+	std::vector<unsigned char> flags; // CAR_INITIALIZED, CAR_STOPPED, CAR_RIDDEN
+} CarTable;
+
+// what the player asked for during one tick, independent of where the key came from
+typedef enum InputAction {
+	INPUT_NONE,
+	INPUT_UP,
+	INPUT_DOWN,
+	INPUT_LEFT,
+	INPUT_RIGHT,
+	INPUT_PICK_UP,
+	INPUT_QUIT,
+	INPUT_SKIP, // end the current round
+	INPUT_ACTIONS
+} InputAction;
+
+typedef struct InputEvent {
+	int action = INPUT_NONE;
+	float time = -1; // game time the key was pressed at, < 0 - the current tick
+} InputEvent;
+
+
+
+//-------------------
+//----DECLARATIONS---
+//-------------------
+
+// Map functions
+void initBoard(GameState* state);
+int obstacleAt(GameState* state, int y, int x);
+void setObstacleRun(GameState* state, int y, int x, int n);
+void setObstacles(GameState* state);
+void obstaclesToArray(GameState* state);
+void setBordersAndSeparators(GameState* state);
+void setFinishLane(GameState* state);
+void buildMap(GameState* state);
+
+// Frog-related functions
+void checkForObstacle(GameState* state);
+void setAllMovementTrue(GameState* state);
+int frogRideOff(GameState* state, CarTable* cars);
+void upCase(GameState* state);
+void downCase(GameState* state);
+void leftCase(GameState* state);
+void rightCase(GameState* state);
+void setFrogSymbol(GameState* state, char symbol);
+void awaitingPickUp(GameState* state);
+void applyInput(GameState* state, CarTable* cars, const InputEvent* input);
+void letAnotherDetect(GameState* state);
+void ifScored(GameState* state);
+
+// Car-related functions
+void typeChoiceCase(int choice, int n, CarTable* cars, unsigned char type, int i);
+void interactionChoiceCase(int choice, int n, CarTable* cars, unsigned char interaction, int i, int color);
+void carDirection(int i, CarTable* cars, GameState* state);
+void initializeCars(CarTable* cars, GameState* state);
+void changeCarAfterNumOfIters(int iterations, CarTable* cars, int i);
+void bounceCar(CarTable* cars, int i, GameState* state);
+void wrapCar(CarTable* cars, int i, GameState* state);
+void disappearCar(CarTable* cars, int i, GameState* state);
+void aggressiveCase(int i, CarTable* cars, GameState* state);
+void passiveCase(int i, CarTable* cars, GameState* state);
+void friendlyCase(int i, CarTable* cars, GameState* state);
+void hits(int i, CarTable* cars, GameState* state);
+
+// Car table functions
+void initCarTable(CarTable* cars, int count);
+void moveCarsScalar(CarTable* cars, int begin, int end, GameState* state);
+void carEdgeEvents(CarTable* cars, int i, GameState* state);
+int moveCarsKernel(CarTable* cars, GameState* state);
+void moveCars(CarTable* cars, GameState* state);
+
+// Lane index functions
+void initCarIndex(GameState* state);
+int addCandidate(int* candidates, int count, int id);
+int collisionCandidates(CarTable* cars, GameState* state, int* candidates);
+void collisionDetect(CarTable* cars, GameState* state);
+
+// Game-related functions
+void changeOfSpeed(GameState* state, CarTable* cars);
+void setNewHighscore(GameState* state);
+void resetVariables(GameState* state, CarTable* cars);
+void resetGame(GameState* state, CarTable* cars);
+void noNegativeScore(GameState* state);
+void seedGame(GameState* state);
+void stepGame(GameState* state, CarTable* cars, const InputEvent* inputs, int count);
@@ -0,0 +1,81 @@
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <poll.h>
+#include <unistd.h>
+#endif
+#include "input.h"
+
+//-------------------
+//-------QUEUE-------
+//-------------------
+
+int pushInput(InputQueue* queue, int action, double time) {
+	if (queue->tail - queue->head >= INPUT_QUEUE_SIZE) {
+		queue->dropped++;
+		return false;
+	}
+	TimedInput* event = &queue->events[queue->tail % INPUT_QUEUE_SIZE];
+	event->action = action;
+	event->time = time;
+	queue->tail++;
+	return true;
+}
+
+int takeTickInputs(InputQueue* queue, SimClock* clock, GameState* state, InputEvent* inputs) {
+	//called right after consumeTick: hand the tick every press that happened before the
+	//moment it stands for, with the press time converted to game time so the jump
+	//delay is measured per key even when several ticks run back to back
+	double tick_time = clock->last_time - clock->accumulator;
+	float tick_start = state->timer;
+	float tick_end = state->timer + TIMER_ADDITION;
+	int count = 0;
+	while (queue->head != queue->tail) {
+		TimedInput* event = &queue->events[queue->head % INPUT_QUEUE_SIZE];
+		if (event->time > tick_time) {
+			break;
+		}
+		float time = tick_end - (float)((tick_time - event->time) / clock->tick_length * TIMER_ADDITION);
+		inputs[count].action = event->action;
+		inputs[count].time = time < tick_start ? tick_start : time;
+		if (event->action != INPUT_NONE && (queue->oldest_shown < 0.0 || event->time < queue->oldest_shown)) {
+			queue->oldest_shown = event->time;
+		}
+		count++;
+		queue->head++;
+	}
+	return count;
+}
+
+double takeInputLatency(InputQueue* queue, double now) {
+	//time from the oldest press applied since the previous frame until this frame
+	//reached the screen, < 0 - nothing was pressed
+	double latency = queue->oldest_shown >= 0.0 ? now - queue->oldest_shown : -1.0;
+	queue->oldest_shown = -1.0;
+	return latency;
+}
+
+
+
+//-------------------
+//------WAITING------
+//-------------------
+
+int waitForInput(int timeout_ms) {
+	//sleep until the terminal has input or the time is up, true - there is input.
+	//A key wakes the loop at once instead of when the next tick or frame is due
+	if (timeout_ms <= 0) {
+		return false;
+	}
+#if defined(_WIN32)
+	//PDCurses reads the console itself, its input handle is signaled while events wait
+	return WaitForSingleObject(GetStdHandle(STD_INPUT_HANDLE), (DWORD)timeout_ms) == WAIT_OBJECT_0;
+#else
+	pollfd fd;
+	fd.fd = STDIN_FILENO;
+	fd.events = POLLIN;
+	fd.revents = 0;
+	return poll(&fd, 1, timeout_ms) > 0;
+#endif
+}
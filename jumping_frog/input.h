@@ -0,0 +1,35 @@
+#pragma once
+#include "game.h"
+#include "clock.h"
+
+#define INPUT_QUEUE_SIZE		64 // power of two
+
+
+
+//-------------------
+//------STRUCTS------
+//-------------------
+// a key press stamped with the real time it was read at
+typedef struct TimedInput {
+	int action = INPUT_NONE;
+	double time = 0.0;
+} TimedInput;
+
+// single producer ring buffer between the key poll and the simulation ticks
+typedef struct InputQueue {
+	TimedInput events[INPUT_QUEUE_SIZE];
+	unsigned int head = 0; // next event to take
+	unsigned int tail = 0; // next free slot
+	long long dropped = 0;
+	double oldest_shown = -1.0; // earliest press applied since the last frame, < 0 - none
+} InputQueue;
+
+
+
+//-------------------
+//----DECLARATIONS---
+//-------------------
+int pushInput(InputQueue* queue, int action, double time);
+int takeTickInputs(InputQueue* queue, SimClock* clock, GameState* state, InputEvent* inputs);
+double takeInputLatency(InputQueue* queue, double now);
+int waitForInput(int timeout_ms);
@@ -0,0 +1,85 @@
+#include "game.h"
+
+//-------------------
+//----LANE INDEX-----
+//-------------------
+
+void initCarIndex(GameState* state) {
+	//a car never leaves its lane, y = (i / cars_per_lane) * 2 + 3, so every lane is a fixed
+	//run of car ids and is laid out once per board instead of sorted every tick
+	CarIndex* index = &state->car_index;
+	index->lane_start.assign(state->height + 1, 0);
+	for (int i = 0; i < state->car_count; i++) {
+		index->lane_start[(i / state->cars_per_lane) * 2 + 3 + 1]++;
+	}
+	for (int y = 0; y < state->height; y++) {
+		index->lane_start[y + 1] += index->lane_start[y];
+	}
+	index->stopped.assign(state->car_count, 0);
+	index->riders.assign(state->car_count, 0);
+	index->candidates.assign(3 * state->car_count, 0);
+	index->stopped_count = 0;
+	index->rider_count = 0;
+}
+
+int addCandidate(int* candidates, int count, int id) {
+	//sorted insert without duplicates, the lists are a handful of cars long
+	int k = count;
+	while (k > 0 && candidates[k - 1] > id) {
+		k--;
+	}
+	if (k > 0 && candidates[k - 1] == id) {
+		return count;
+	}
+	for (int j = count; j > k; j--) {
+		candidates[j] = candidates[j - 1];
+	}
+	candidates[k] = id;
+	return count + 1;
+}
+
+int collisionCandidates(CarTable* cars, GameState* state, int* candidates) {
+	//only cars that can react to the frog this tick: cars near it in its own lane,
+	//cars it stopped last tick (they need to start again) and cars it is riding
+	CarIndex* index = &state->car_index;
+	int count = 0;
+	if (state->frog_y >= 0 && state->frog_y < state->height) {
+		//wide enough to cover the frog being moved onto a friendly car mid-check
+		float margin = CAR_BRAKE_DISTANCE + 2 * state->r + 1;
+		float low = state->frog_x - margin;
+		float high = state->frog_x + margin;
+		//the lane's ids are ascending, so the list stays sorted without addCandidate
+		for (int i = index->lane_start[state->frog_y]; i < index->lane_start[state->frog_y + 1]; i++) {
+			if (cars->x[i] >= low && cars->x[i] <= high) {
+				candidates[count++] = i;
+			}
+		}
+	}
+	for (int k = 0; k < index->stopped_count; k++) {
+		count = addCandidate(candidates, count, index->stopped[k]);
+	}
+	for (int k = 0; k < index->rider_count; k++) {
+		count = addCandidate(candidates, count, index->riders[k]);
+	}
+	return count;
+}
+
+void collisionDetect(CarTable* cars, GameState* state) {
+	//same result as running hits() on every car, but a car that is nowhere near
+	//the frog would only get CAR_STOPPED cleared, which it already has
+	CarIndex* index = &state->car_index;
+	int* candidates = index->candidates.data();
+	int count = collisionCandidates(cars, state, candidates);
+	index->stopped_count = 0;
+	index->rider_count = 0;
+	for (int k = 0; k < count; k++) {
+		int i = candidates[k];
+		hits(i, cars, state);
+		if (cars->flags[i] & CAR_STOPPED) {
+			index->stopped[index->stopped_count++] = i;
+		}
+		if (cars->flags[i] & CAR_RIDDEN) {
+			index->riders[index->rider_count++] = i;
+		}
+	}
+}
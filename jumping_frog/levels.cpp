@@ -0,0 +1,227 @@
+#include "levels.h"
+
+
+
+//-------------------
+//------LAYOUT-------
+//-------------------
+
+void levelParams(GameState* state, LevelParams* params) {
+	params->width = state->width;
+	params->height = state->height;
+	params->row_words = state->row_words;
+	params->obstacle_count = state->obstacle_count;
+	params->obstacle_ramp = state->obstacle_ramp;
+	params->min_length = MIN_OBSTACLE_LENGTH;
+	params->max_length = state->obstacle_length > MIN_OBSTACLE_LENGTH ? state->obstacle_length : MIN_OBSTACLE_LENGTH;
+	params->seed = state->seed;
+}
+
+int countBits(uint64_t bits) {
+	bits = bits - ((bits >> 1) & 0x5555555555555555ull);
+	bits = (bits & 0x3333333333333333ull) + ((bits >> 2) & 0x3333333333333333ull);
+	bits = (bits + (bits >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+	return (int)((bits * 0x0101010101010101ull) >> 56);
+}
+
+int nthBit(uint64_t bits, int n) {
+	//position of the n-th (from 0) set bit, counted from the lowest
+	for (int i = 0; i < n; i++) {
+		bits &= bits - 1;
+	}
+	int position = 0;
+	while (!(bits & 1)) {
+		bits >>= 1;
+		position++;
+	}
+	return position;
+}
+
+int freeRunStarts(const LevelParams* params, const uint64_t* row, int n, uint64_t* starts) {
+	//bit x of starts is set when an obstacle of length n can start at x, runs going
+	//past the right border are cut there so the cells beyond it count as free
+	int words = params->row_words;
+	for (int w = 0; w < words; w++) {
+		starts[w] = ~row[w];
+	}
+	//each pass keeps the starts whose next cell is free too
+	for (int k = 1; k < n; k++) {
+		for (int w = 0; w < words; w++) {
+			uint64_t next = w + 1 < words ? starts[w + 1] << 63 : 1ull << 63;
+			starts[w] &= (starts[w] >> 1) | next;
+		}
+	}
+	//obstacles start inside the side borders
+	starts[0] &= ~1ull;
+	int count = 0;
+	for (int w = 0; w < words; w++) {
+		int first = w * 64;
+		if (first + 64 > params->width - 1) {
+			int keep = params->width - 1 - first;
+			starts[w] &= keep > 0 ? ~0ull >> (64 - keep) : 0;
+		}
+		count += countBits(starts[w]);
+	}
+	return count;
+}
+
+void placeRun(uint64_t* row, int x, int n) {
+	for (int i = x; i < x + n; i++) {
+		row[i >> 6] |= 1ull << (i & 63);
+	}
+}
+
+void placeObstacles(const LevelParams* params, int count, Rng* rng, uint64_t* obstacles) {
+	//every obstacle picks its length, then a start among all the places on the
+	//separator rows it still fits, so nothing ever has to be drawn again
+	int words = params->row_words;
+	int lengths = params->max_length - params->min_length + 1;
+	std::vector<uint64_t> starts(words);
+	//free starts of every row for every length, only the row that got an obstacle is counted again
+	std::vector<int> row_count(params->height * lengths);
+	for (int y = 2; y < params->height - 2; y += 2) {
+		for (int k = 0; k < lengths; k++) {
+			row_count[y * lengths + k] = freeRunStarts(params, &obstacles[y * words], params->min_length + k, starts.data());
+		}
+	}
+	for (int i = 0; i < count; i++) {
+		int n = randomBelow(rng, params->max_length) + 1;
+		if (n < params->min_length) {
+			n = params->min_length;
+		}
+		int k = n - params->min_length;
+		int total = 0;
+		for (int y = 2; y < params->height - 2; y += 2) {
+			total += row_count[y * lengths + k];
+		}
+		if (total == 0) {
+			break;
+		}
+		int pick = randomBelow(rng, total);
+		int y = 2;
+		while (pick >= row_count[y * lengths + k]) {
+			pick -= row_count[y * lengths + k];
+			y += 2;
+		}
+		uint64_t* row = &obstacles[y * words];
+		freeRunStarts(params, row, n, starts.data());
+		for (int w = 0; w < words; w++) {
+			int in_word = countBits(starts[w]);
+			if (pick < in_word) {
+				int x = w * 64 + nthBit(starts[w], pick);
+				placeRun(row, x, x + n < params->width - 1 ? n : params->width - 1 - x);
+				break;
+			}
+			pick -= in_word;
+		}
+		for (int j = 0; j < lengths; j++) {
+			row_count[y * lengths + j] = freeRunStarts(params, row, params->min_length + j, starts.data());
+		}
+	}
+}
+
+int levelReachable(const LevelParams* params, const uint64_t* obstacles) {
+	//breadth first search from the frog's start cell, the finish lane is row 1. The frog
+	//only ever stands on x in [2, width-2], leftCase and rightCase stop it there
+	int width = params->width;
+	int height = params->height;
+	std::vector<char> seen(width * height, 0);
+	std::vector<int> queue;
+	queue.reserve(width * height);
+	int start = (height - 2) * width + width / 2;
+	seen[start] = 1;
+	queue.push_back(start);
+	const int steps[] = { -width, width, -1, 1 };
+	for (size_t head = 0; head < queue.size(); head++) {
+		int cell = queue[head];
+		if (cell / width == 1) {
+			return true;
+		}
+		for (int step : steps) {
+			int next = cell + step;
+			int y = next / width;
+			int x = next % width;
+			if (y < 1 || y > height - 2 || x < 2 || x > width - 2 || seen[next]) {
+				continue;
+			}
+			if ((obstacles[y * params->row_words + (x >> 6)] >> (x & 63)) & 1) {
+				continue;
+			}
+			seen[next] = 1;
+			queue.push_back(next);
+		}
+	}
+	return false;
+}
+
+void openBlockedRows(const LevelParams* params, Rng* rng, uint64_t* obstacles) {
+	//lanes never hold obstacles, so one free cell in every separator row is enough to get through,
+	//as long as it is one the frog can stand on
+	int words = params->row_words;
+	int width = params->width;
+	for (int y = 2; y < params->height - 2; y += 2) {
+		uint64_t* row = &obstacles[y * words];
+		int blocked = 0;
+		for (int x = 2; x <= width - 2; x++) {
+			blocked += (row[x >> 6] >> (x & 63)) & 1;
+		}
+		if (blocked >= width - 3) {
+			int x = randomBelow(rng, width - 3) + 2;
+			row[x >> 6] &= ~(1ull << (x & 63));
+		}
+	}
+}
+
+void generateLevel(const LevelParams* params, int number, std::vector<uint64_t>* obstacles) {
+	//every level has its own generator, so levels can be built in any order on any thread
+	Rng rng;
+	seedRng(&rng, ((uint64_t)(uint32_t)params->seed << 32) | (uint32_t)number);
+	obstacles->assign(params->height * params->row_words, 0);
+	placeObstacles(params, params->obstacle_count + number * params->obstacle_ramp, &rng, obstacles->data());
+	if (!levelReachable(params, obstacles->data())) {
+		openBlockedRows(params, &rng, obstacles->data());
+	}
+}
+
+
+
+//-------------------
+//-------CACHE-------
+//-------------------
+
+void levelWorker(LevelCache* cache) {
+	for (int i = 0; i < (int)cache->levels.size() && !cache->stop.load(std::memory_order_relaxed); i++) {
+		generateLevel(&cache->params, i, &cache->levels[i]);
+		cache->ready.store(i + 1, std::memory_order_release);
+	}
+}
+
+void startLevelCache(LevelCache* cache, GameState* state, int count) {
+	//call once the board is built and the game seeded
+	levelParams(state, &cache->params);
+	cache->levels.assign(count, std::vector<uint64_t>());
+	cache->ready.store(0);
+	cache->stop.store(false);
+	cache->worker = std::thread(levelWorker, cache);
+	state->levels = cache;
+}
+
+void stopLevelCache(LevelCache* cache) {
+	cache->stop.store(true);
+	if (cache->worker.joinable()) {
+		cache->worker.join();
+	}
+}
+
+void takeLevel(GameState* state) {
+	//level n goes with layout n, a level the worker has not got to yet is built right here
+	int number = state->layout;
+	LevelCache* cache = state->levels;
+	if (cache != nullptr && number < cache->ready.load(std::memory_order_acquire)) {
+		state->obstacles = cache->levels[number];
+		return;
+	}
+	LevelParams params;
+	levelParams(state, &params);
+	generateLevel(&params, number, &state->obstacles);
+}
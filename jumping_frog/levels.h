@@ -0,0 +1,57 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include "game.h"
+
+#define LEVEL_CACHE_SIZE		32 // levels generated ahead at startup
+
+
+
+//-------------------
+//------STRUCTS------
+//-------------------
+// everything a layout depends on, level n of a seed is the same on every machine and thread
+typedef struct LevelParams {
+	int width = 0;
+	int height = 0;
+	int row_words = 0;
+	int obstacle_count = 0; // runs on the first level
+	int obstacle_ramp = 0; // extra runs every following level
+	int min_length = MIN_OBSTACLE_LENGTH;
+	int max_length = MAX_OBSTACLE_LENGTH;
+	int seed = 0;
+} LevelParams;
+
+// obstacle layouts built by a background thread, handed out as rounds start
+typedef struct LevelCache {
+	LevelParams params;
+	std::vector<std::vector<uint64_t>> levels;
+	std::atomic<int> ready{ 0 }; // levels[0, ready) are done
+	std::atomic<bool> stop{ false };
+	std::thread worker;
+} LevelCache;
+
+
+
+//-------------------
+//----DECLARATIONS---
+//-------------------
+
+// Layout functions
+void levelParams(GameState* state, LevelParams* params);
+int countBits(uint64_t bits);
+int nthBit(uint64_t bits, int n);
+int freeRunStarts(const LevelParams* params, const uint64_t* row, int n, uint64_t* starts);
+void placeRun(uint64_t* row, int x, int n);
+void placeObstacles(const LevelParams* params, int count, Rng* rng, uint64_t* obstacles);
+int levelReachable(const LevelParams* params, const uint64_t* obstacles);
+void openBlockedRows(const LevelParams* params, Rng* rng, uint64_t* obstacles);
+void generateLevel(const LevelParams* params, int number, std::vector<uint64_t>* obstacles);
+
+// Cache functions
+void levelWorker(LevelCache* cache);
+void startLevelCache(LevelCache* cache, GameState* state, int count);
+void stopLevelCache(LevelCache* cache);
+void takeLevel(GameState* state);
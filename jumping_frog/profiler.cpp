@@ -0,0 +1,117 @@
+#include <stdio.h>
+#include "profiler.h"
+#include "clock.h"
+
+//-------------------
+//-----PROFILER------
+//-------------------
+
+void initProfiler(Profiler* profiler) {
+	for (int i = 0; i < PHASE_COUNT; i++) {
+		PhaseHistogram* histogram = &profiler->phases[i];
+		for (int j = 0; j < PROFILE_BUCKETS; j++) {
+			histogram->buckets[j] = 0;
+		}
+		histogram->count = 0;
+		histogram->total_us = 0;
+		histogram->max_us = 0;
+	}
+	profiler->ticks = 0;
+	profiler->frames = 0;
+	profiler->start = clockNow();
+}
+
+int profileBucket(uint64_t us) {
+	//exact below PROFILE_SUB_BUCKETS, above that PROFILE_SUB_BUCKETS steps per power of two
+	if (us < PROFILE_SUB_BUCKETS) {
+		return (int)us;
+	}
+	int exponent = 63;
+	while (!(us >> exponent)) {
+		exponent--;
+	}
+	int bucket = (exponent - 2) * PROFILE_SUB_BUCKETS + (int)((us >> (exponent - 3)) & (PROFILE_SUB_BUCKETS - 1));
+	return bucket < PROFILE_BUCKETS ? bucket : PROFILE_BUCKETS - 1;
+}
+
+uint64_t profileBucketLow(int bucket) {
+	if (bucket < PROFILE_SUB_BUCKETS) {
+		return (uint64_t)bucket;
+	}
+	int exponent = bucket / PROFILE_SUB_BUCKETS + 2;
+	uint64_t step = (uint64_t)1 << (exponent - 3);
+	return ((uint64_t)1 << exponent) + (bucket % PROFILE_SUB_BUCKETS) * step;
+}
+
+void recordPhase(Profiler* profiler, int phase, double seconds) {
+	PhaseHistogram* histogram = &profiler->phases[phase];
+	uint64_t us = seconds > 0.0 ? (uint64_t)(seconds * 1e6) : 0;
+	histogram->buckets[profileBucket(us)].fetch_add(1, std::memory_order_relaxed);
+	histogram->count.fetch_add(1, std::memory_order_relaxed);
+	histogram->total_us.fetch_add(us, std::memory_order_relaxed);
+	uint64_t max = histogram->max_us.load(std::memory_order_relaxed);
+	while (us > max && !histogram->max_us.compare_exchange_weak(max, us, std::memory_order_relaxed)) {
+	}
+}
+
+double phasePercentile(const PhaseHistogram* histogram, double percentile) {
+	//upper edge of the bucket holding the requested sample, never more than max
+	uint64_t count = histogram->count.load(std::memory_order_relaxed);
+	if (count == 0) {
+		return 0.0;
+	}
+	uint64_t rank = (uint64_t)(percentile / 100.0 * (count - 1)) + 1;
+	uint64_t seen = 0;
+	uint64_t max = histogram->max_us.load(std::memory_order_relaxed);
+	for (int i = 0; i < PROFILE_BUCKETS; i++) {
+		seen += histogram->buckets[i].load(std::memory_order_relaxed);
+		if (seen >= rank) {
+			uint64_t high = i + 1 < PROFILE_BUCKETS ? profileBucketLow(i + 1) - 1 : max;
+			return (double)(high < max ? high : max);
+		}
+	}
+	return (double)max;
+}
+
+const char* phaseName(int phase) {
+	static const char* names[PHASE_COUNT] = { "simulate", "build_frame", "refresh", "input", "input_latency" };
+	return phase >= 0 && phase < PHASE_COUNT ? names[phase] : "";
+}
+
+int writeProfileCsv(Profiler* profiler, const char* summary_path, const char* buckets_path) {
+	FILE* summary = fopen(summary_path, "w");
+	if (summary == NULL) {
+		return false;
+	}
+	double seconds = clockNow() - profiler->start;
+	fprintf(summary, "phase,count,mean_us,p50_us,p90_us,p99_us,p999_us,max_us\n");
+	for (int i = 0; i < PHASE_COUNT; i++) {
+		const PhaseHistogram* histogram = &profiler->phases[i];
+		uint64_t count = histogram->count.load();
+		fprintf(summary, "%s,%llu,%.2f,%.0f,%.0f,%.0f,%.0f,%llu\n", phaseName(i), (unsigned long long)count,
+			count > 0 ? (double)histogram->total_us.load() / count : 0.0,
+			phasePercentile(histogram, 50.0), phasePercentile(histogram, 90.0),
+			phasePercentile(histogram, 99.0), phasePercentile(histogram, 99.9),
+			(unsigned long long)histogram->max_us.load());
+	}
+	fprintf(summary, "ticks_per_s,%.2f\n", seconds > 0.0 ? profiler->ticks.load() / seconds : 0.0);
+	fprintf(summary, "frames_per_s,%.2f\n", seconds > 0.0 ? profiler->frames.load() / seconds : 0.0);
+	fclose(summary);
+
+	FILE* buckets = fopen(buckets_path, "w");
+	if (buckets == NULL) {
+		return false;
+	}
+	fprintf(buckets, "phase,from_us,to_us,count\n");
+	for (int i = 0; i < PHASE_COUNT; i++) {
+		for (int j = 0; j < PROFILE_BUCKETS; j++) {
+			uint64_t count = profiler->phases[i].buckets[j].load();
+			if (count > 0) {
+				fprintf(buckets, "%s,%llu,%llu,%llu\n", phaseName(i), (unsigned long long)profileBucketLow(j),
+					(unsigned long long)(j + 1 < PROFILE_BUCKETS ? profileBucketLow(j + 1) - 1 : ~0ull), (unsigned long long)count);
+			}
+		}
+	}
+	fclose(buckets);
+	return true;
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <atomic>
+#include <stdint.h>
+
+#define PROFILE_SUB_BUCKETS		8 // buckets per power of two, ~12% resolution
+#define PROFILE_BUCKETS			192 // covers up to ~60 s in microseconds
+#define PROFILE_CSV				"profile.csv"
+#define PROFILE_BUCKETS_CSV		"profile_buckets.csv"
+
+
+
+//-------------------
+//------STRUCTS------
+//-------------------
+typedef enum ProfilePhase {
+	PHASE_SIMULATE,
+	PHASE_BUILD_FRAME,
+	PHASE_REFRESH,
+	PHASE_INPUT,
+	PHASE_INPUT_LATENCY, // key press until the frame showing it was refreshed
+	PHASE_COUNT
+} ProfilePhase;
+
+// log-linear histogram of durations in microseconds, every field is updated
+// with relaxed atomic adds so any thread can record or read it without a lock
+typedef struct PhaseHistogram {
+	std::atomic<uint64_t> buckets[PROFILE_BUCKETS];
+	std::atomic<uint64_t> count;
+	std::atomic<uint64_t> total_us;
+	std::atomic<uint64_t> max_us;
+} PhaseHistogram;
+
+typedef struct Profiler {
+	PhaseHistogram phases[PHASE_COUNT];
+	std::atomic<uint64_t> ticks;
+	std::atomic<uint64_t> frames;
+	double start = 0.0;
+	bool overlay = false;
+} Profiler;
+
+
+
+//-------------------
+//----DECLARATIONS---
+//-------------------
+void initProfiler(Profiler* profiler);
+int profileBucket(uint64_t us);
+uint64_t profileBucketLow(int bucket);
+void recordPhase(Profiler* profiler, int phase, double seconds);
+double phasePercentile(const PhaseHistogram* histogram, double percentile);
+const char* phaseName(int phase);
+int writeProfileCsv(Profiler* profiler, const char* summary_path, const char* buckets_path);
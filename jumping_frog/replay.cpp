@@ -0,0 +1,279 @@
+#include <stdio.h>
+#include <string.h>
+#include "replay.h"
+#include "config.h"
+
+#define REPLAY_MAX_TICK_INPUTS	64
+
+
+
+//-------------------
+//-----RECORDING-----
+//-------------------
+
+void putVarint(std::vector<unsigned char>* out, uint64_t value) {
+	//7 bits per byte, high bit set on every byte but the last
+	while (value >= 0x80) {
+		out->push_back((unsigned char)(value | 0x80));
+		value >>= 7;
+	}
+	out->push_back((unsigned char)value);
+}
+
+void putU32(std::vector<unsigned char>* out, uint32_t value) {
+	for (int i = 0; i < 4; i++) {
+		out->push_back((unsigned char)(value >> (8 * i)));
+	}
+}
+
+std::string configValues(GameState* state) {
+	//the values the game ran with, the board already resolved so the
+	//terminal size of the machine playing it back does not matter
+	char buffer[1024];
+	snprintf(buffer, sizeof(buffer),
+		"frog_color=%d\npassive_car_color=%d\naggressive_car_color=%d\nfriendly_car_color=%d\n"
+		"number_of_bounces=%d\nnumber_of_wraps=%d\nfrog_symbol=%c\ncar_symbol=%c\nborder_symbol=%c\n"
+		"lane_separator=%c\nmax_time=%d\ntick_rate=%d\nrender_rate=%d\nmax_catch_up=%d\n"
+		"board_width=%d\nboard_height=0\nlanes=%d\ncars_per_lane=%d\nfit_terminal=0\n"
+		"max_obstacles=%d\nobstacle_length=%d\nobstacle_ramp=%d\n",
+		state->frog_color, state->passive_car_color, state->aggressive_car_color, state->friendly_car_color,
+		state->number_of_bounces, state->number_of_wraps, state->frog_symbol, state->car_symbol, state->border_symbol,
+		state->lane_separator, state->max_time, state->tick_rate, state->render_rate, state->max_catch_up,
+		state->width, state->lanes, state->cars_per_lane, state->obstacle_count, state->obstacle_length, state->obstacle_ramp);
+	return buffer;
+}
+
+void startReplay(Replay* replay, GameState* state) {
+	//call once the board is built and the game seeded, before the first tick
+	*replay = Replay();
+	replay->seed = state->seed;
+	replay->config = configValues(state);
+}
+
+void recordTick(Replay* replay, const InputEvent* inputs, int count) {
+	//idle ticks cost nothing, a busy one a couple of bytes per key
+	if (count > 0) {
+		putVarint(&replay->events, (uint64_t)(replay->ticks - replay->last_event_tick));
+		putVarint(&replay->events, (uint64_t)count);
+		for (int i = 0; i < count; i++) {
+			uint32_t time;
+			memcpy(&time, &inputs[i].time, sizeof(time));
+			replay->events.push_back((unsigned char)inputs[i].action);
+			putU32(&replay->events, time);
+		}
+		replay->last_event_tick = replay->ticks;
+	}
+	replay->ticks++;
+}
+
+void finishReplay(Replay* replay, GameState* state, CarTable* cars) {
+	replay->checksum = gameChecksum(state, cars);
+	replay->points = state->points;
+	replay->highscore = state->highscore;
+}
+
+uint32_t gameChecksum(GameState* state, CarTable* cars) {
+	//FNV-1a over everything a desync would show up in sooner or later
+	uint32_t hash = 2166136261u;
+	int values[] = { state->frog_x, state->frog_y, state->points, state->highscore, state->collisionDetected, state->crossings, state->layout };
+	const unsigned char* bytes = (const unsigned char*)values;
+	for (size_t i = 0; i < sizeof(values); i++) {
+		hash = (hash ^ bytes[i]) * 16777619u;
+	}
+	bytes = (const unsigned char*)&state->timer;
+	for (size_t i = 0; i < sizeof(state->timer); i++) {
+		hash = (hash ^ bytes[i]) * 16777619u;
+	}
+	bytes = (const unsigned char*)cars->x.data();
+	for (size_t i = 0; i < cars->x.size() * sizeof(float); i++) {
+		hash = (hash ^ bytes[i]) * 16777619u;
+	}
+	return hash;
+}
+
+
+
+//-------------------
+//-------FILES-------
+//-------------------
+
+int saveReplay(const Replay* replay, const char* filename) {
+	std::vector<unsigned char> out(REPLAY_MAGIC, REPLAY_MAGIC + strlen(REPLAY_MAGIC));
+	out.push_back(REPLAY_VERSION);
+	putU32(&out, (uint32_t)replay->seed);
+	putVarint(&out, replay->config.size());
+	out.insert(out.end(), replay->config.begin(), replay->config.end());
+	putVarint(&out, replay->events.size());
+	out.insert(out.end(), replay->events.begin(), replay->events.end());
+	putVarint(&out, (uint64_t)replay->ticks);
+	putU32(&out, replay->checksum);
+	putU32(&out, (uint32_t)replay->points);
+	putU32(&out, (uint32_t)replay->highscore);
+
+	FILE* file = fopen(filename, "wb");
+	if (file == NULL) {
+		return false;
+	}
+	size_t written = fwrite(out.data(), 1, out.size(), file);
+	fclose(file);
+	return written == out.size();
+}
+
+int getVarint(const std::vector<unsigned char>* in, size_t* at, uint64_t* value) {
+	*value = 0;
+	for (int shift = 0; shift < 64; shift += 7) {
+		if (*at >= in->size()) {
+			return false;
+		}
+		unsigned char byte = (*in)[(*at)++];
+		*value |= (uint64_t)(byte & 0x7f) << shift;
+		if (!(byte & 0x80)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+int getU32(const std::vector<unsigned char>* in, size_t* at, uint32_t* value) {
+	if (*at + 4 > in->size()) {
+		return false;
+	}
+	*value = 0;
+	for (int i = 0; i < 4; i++) {
+		*value |= (uint32_t)(*in)[(*at)++] << (8 * i);
+	}
+	return true;
+}
+
+int loadReplay(Replay* replay, const char* filename) {
+	FILE* file = fopen(filename, "rb");
+	if (file == NULL) {
+		return false;
+	}
+	std::vector<unsigned char> in;
+	unsigned char chunk[4096];
+	size_t read;
+	while ((read = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+		in.insert(in.end(), chunk, chunk + read);
+	}
+	fclose(file);
+
+	size_t magic = strlen(REPLAY_MAGIC);
+	if (in.size() < magic + 1 || memcmp(in.data(), REPLAY_MAGIC, magic) != 0 || in[magic] != REPLAY_VERSION) {
+		return false;
+	}
+	size_t at = magic + 1;
+	uint32_t seed, checksum, points, highscore;
+	uint64_t config_size, events_size, ticks;
+	if (!getU32(&in, &at, &seed) || !getVarint(&in, &at, &config_size) || config_size > in.size() - at) {
+		return false;
+	}
+	*replay = Replay();
+	replay->seed = (int)seed;
+	replay->config.assign((const char*)in.data() + at, (size_t)config_size);
+	at += (size_t)config_size;
+	if (!getVarint(&in, &at, &events_size) || events_size > in.size() - at) {
+		return false;
+	}
+	replay->events.assign(in.begin() + at, in.begin() + at + (size_t)events_size);
+	at += (size_t)events_size;
+	if (!getVarint(&in, &at, &ticks) || !getU32(&in, &at, &checksum) || !getU32(&in, &at, &points) || !getU32(&in, &at, &highscore)) {
+		return false;
+	}
+	replay->ticks = (long long)ticks;
+	replay->checksum = checksum;
+	replay->points = (int)points;
+	replay->highscore = (int)highscore;
+	return true;
+}
+
+
+
+//-------------------
+//-----PLAYBACK------
+//-------------------
+
+void applyReplayConfig(const Replay* replay, GameState* state) {
+	//same key=value parsing as config.txt, keys an older replay lacks keep their defaults
+	applyConfigDefaults(state);
+	parseConfigText(replay->config.data(), replay->config.size(), state, false, NULL);
+	state->seed = replay->seed;
+}
+
+long long readEventTick(ReplayPlayer* player, long long after) {
+	uint64_t delta;
+	if (!getVarint(&player->replay->events, &player->cursor, &delta)) {
+		return -1;
+	}
+	return after + (long long)delta;
+}
+
+void initPlayer(ReplayPlayer* player, const Replay* replay) {
+	player->replay = replay;
+	player->state = GameState();
+	applyReplayConfig(replay, &player->state);
+	initBoard(&player->state);
+	initCarTable(&player->cars, player->state.car_count);
+	seedGame(&player->state);
+	player->tick = 0;
+	player->cursor = 0;
+	player->next_event_tick = readEventTick(player, 0);
+	player->snapshots.clear();
+	player->snapshots.push_back({ 0, player->cursor, player->next_event_tick, player->state, player->cars });
+}
+
+void stepPlayer(ReplayPlayer* player) {
+	InputEvent inputs[REPLAY_MAX_TICK_INPUTS];
+	int count = 0;
+	if (player->next_event_tick == player->tick) {
+		const std::vector<unsigned char>* events = &player->replay->events;
+		uint64_t recorded = 0;
+		getVarint(events, &player->cursor, &recorded);
+		for (uint64_t i = 0; i < recorded && player->cursor + 5 <= events->size(); i++) {
+			InputEvent input;
+			uint32_t time;
+			input.action = (*events)[player->cursor++];
+			getU32(events, &player->cursor, &time);
+			memcpy(&input.time, &time, sizeof(time));
+			if (count < REPLAY_MAX_TICK_INPUTS) {
+				inputs[count++] = input;
+			}
+		}
+		player->next_event_tick = readEventTick(player, player->tick);
+	}
+	stepGame(&player->state, &player->cars, inputs, count);
+	player->tick++;
+	if (player->tick % REPLAY_SNAPSHOT_TICKS == 0 && player->snapshots.back().tick < player->tick) {
+		player->snapshots.push_back({ player->tick, player->cursor, player->next_event_tick, player->state, player->cars });
+	}
+}
+
+void seekPlayer(ReplayPlayer* player, long long tick) {
+	//jump to the last snapshot at or before tick when going back or when it saves
+	//simulating ticks, then play forward from there
+	if (tick > player->replay->ticks) {
+		tick = player->replay->ticks;
+	}
+	int low = 0;
+	int high = (int)player->snapshots.size() - 1;
+	while (low < high) {
+		int middle = (low + high + 1) / 2;
+		if (player->snapshots[middle].tick <= tick) {
+			low = middle;
+		}
+		else {
+			high = middle - 1;
+		}
+	}
+	const ReplaySnapshot* snapshot = &player->snapshots[low];
+	if (tick < player->tick || snapshot->tick > player->tick) {
+		player->tick = snapshot->tick;
+		player->cursor = snapshot->cursor;
+		player->next_event_tick = snapshot->next_event_tick;
+		player->state = snapshot->state;
+		player->cars = snapshot->cars;
+	}
+	while (player->tick < tick) {
+		stepPlayer(player);
+	}
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "game.h"
+
+#define REPLAY_FILE				"last_replay.frog"
+#define REPLAY_MAGIC			"FROGRPL"
+#define REPLAY_VERSION			1
+#define REPLAY_SNAPSHOT_TICKS	4096 // playback keeps a full copy of the game this often for seeking
+
+
+
+//-------------------
+//------STRUCTS------
+//-------------------
+// everything needed to re-simulate a session: seed, config and the inputs of every tick
+// events are packed as varint(ticks since the previous busy tick), varint(count), then
+// count times action byte + game time float, all little endian
+typedef struct Replay {
+	int seed = 0;
+	std::string config; // key=value lines, read back with parseConfigText
+	std::vector<unsigned char> events;
+	long long ticks = 0;
+	long long last_event_tick = 0;
+	uint32_t checksum = 0; // gameChecksum after the last tick, 0 - not known
+	int points = 0;
+	int highscore = 0;
+} Replay;
+
+typedef struct ReplaySnapshot {
+	long long tick = 0;
+	size_t cursor = 0;
+	long long next_event_tick = 0;
+	GameState state;
+	CarTable cars;
+} ReplaySnapshot;
+
+// re-simulates a replay, snapshots taken on the way let it seek backwards
+typedef struct ReplayPlayer {
+	const Replay* replay = nullptr;
+	GameState state;
+	CarTable cars;
+	long long tick = 0;
+	size_t cursor = 0; // next byte of replay->events
+	long long next_event_tick = -1; // tick the event at cursor belongs to, -1 - no more events
+	std::vector<ReplaySnapshot> snapshots; // every REPLAY_SNAPSHOT_TICKS ticks, in tick order
+} ReplayPlayer;
+
+
+
+//-------------------
+//----DECLARATIONS---
+//-------------------
+
+// Recording functions
+void putVarint(std::vector<unsigned char>* out, uint64_t value);
+void putU32(std::vector<unsigned char>* out, uint32_t value);
+std::string configValues(GameState* state);
+void startReplay(Replay* replay, GameState* state);
+void recordTick(Replay* replay, const InputEvent* inputs, int count);
+void finishReplay(Replay* replay, GameState* state, CarTable* cars);
+uint32_t gameChecksum(GameState* state, CarTable* cars);
+
+// File functions
+int saveReplay(const Replay* replay, const char* filename);
+int getVarint(const std::vector<unsigned char>* in, size_t* at, uint64_t* value);
+int getU32(const std::vector<unsigned char>* in, size_t* at, uint32_t* value);
+int loadReplay(Replay* replay, const char* filename);
+
+// Playback functions
+void applyReplayConfig(const Replay* replay, GameState* state);
+long long readEventTick(ReplayPlayer* player, long long after);
+void initPlayer(ReplayPlayer* player, const Replay* replay);
+void stepPlayer(ReplayPlayer* player);
+void seekPlayer(ReplayPlayer* player, long long tick);
@@ -0,0 +1,67 @@
+#pragma once
+#include <stdint.h>
+
+//-------------------
+//------STRUCTS------
+//-------------------
+// per-instance xoshiro256** generator, every GameState owns one so simulations
+// running on different threads never share state and a seed replays a run exactly
+typedef struct Rng {
+	uint64_t s[4] = { 0x9E3779B97F4A7C15ull, 0xBF58476D1CE4E5B9ull, 0x94D049BB133111EBull, 0x2545F4914F6CDD1Dull };
+} Rng;
+
+
+
+//-------------------
+//-------RANDOM------
+//-------------------
+
+inline uint64_t splitMix64(uint64_t* x) {
+	uint64_t z = (*x += 0x9E3779B97F4A7C15ull);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	return z ^ (z >> 31);
+}
+
+inline uint64_t rotateLeft(uint64_t x, int k) {
+	return (x << k) | (x >> (64 - k));
+}
+
+inline void seedRng(Rng* rng, uint64_t seed) {
+	//splitmix spreads even neighbouring seeds (0, 1, 2...) over the whole state
+	for (int i = 0; i < 4; i++) {
+		rng->s[i] = splitMix64(&seed);
+	}
+}
+
+inline uint64_t nextRandom64(Rng* rng) {
+	uint64_t* s = rng->s;
+	uint64_t result = rotateLeft(s[1] * 5, 7) * 9;
+	uint64_t t = s[1] << 17;
+	s[2] ^= s[0];
+	s[3] ^= s[1];
+	s[1] ^= s[2];
+	s[0] ^= s[3];
+	s[2] ^= t;
+	s[3] = rotateLeft(s[3], 45);
+	return result;
+}
+
+inline uint32_t nextRandom(Rng* rng) {
+	return (uint32_t)(nextRandom64(rng) >> 32);
+}
+
+inline int randomBelow(Rng* rng, int n) {
+	//multiply-shift instead of %, rejecting the few values that would favour low results
+	uint32_t range = (uint32_t)n;
+	uint64_t m = (uint64_t)nextRandom(rng) * range;
+	uint32_t low = (uint32_t)m;
+	if (low < range) {
+		uint32_t threshold = (0u - range) % range;
+		while (low < threshold) {
+			m = (uint64_t)nextRandom(rng) * range;
+			low = (uint32_t)m;
+		}
+	}
+	return (int)(m >> 32);
+}
@@ -0,0 +1,333 @@
+#include <string.h>
+#include "snapshot.h"
+
+#define SNAPSHOT_VERSION		1
+
+
+
+//-------------------
+//-------BITS--------
+//-------------------
+
+void putBits(BitWriter* writer, uint64_t value, int count) {
+	//at most 32 bits go in at a time so buffer (< 8 bits left over) never overflows
+	while (count > 0) {
+		int take = count < 32 ? count : 32;
+		writer->buffer |= (value & ((1ull << take) - 1)) << writer->bits;
+		writer->bits += take;
+		value = take < 64 ? value >> take : 0;
+		count -= take;
+		while (writer->bits >= 8) {
+			writer->out->push_back((unsigned char)writer->buffer);
+			writer->buffer >>= 8;
+			writer->bits -= 8;
+		}
+	}
+}
+
+void putBitsVarint(BitWriter* writer, uint64_t value) {
+	//small counters are the common case, 4 bits plus a continue bit per group
+	do {
+		uint64_t group = value & 15;
+		value >>= 4;
+		putBits(writer, group | (value != 0 ? 16 : 0), 5);
+	} while (value != 0);
+}
+
+void flushBits(BitWriter* writer) {
+	if (writer->bits > 0) {
+		writer->out->push_back((unsigned char)writer->buffer);
+		writer->buffer = 0;
+		writer->bits = 0;
+	}
+}
+
+uint64_t getBits(BitReader* reader, int count) {
+	uint64_t value = 0;
+	int done = 0;
+	while (done < count) {
+		int take = count - done < 32 ? count - done : 32;
+		while (reader->bits < take) {
+			if (reader->at >= reader->in->size()) {
+				reader->overrun = true;
+				return 0;
+			}
+			reader->buffer |= (uint64_t)(*reader->in)[reader->at++] << reader->bits;
+			reader->bits += 8;
+		}
+		value |= (reader->buffer & ((1ull << take) - 1)) << done;
+		reader->buffer >>= take;
+		reader->bits -= take;
+		done += take;
+	}
+	return value;
+}
+
+uint64_t getBitsVarint(BitReader* reader) {
+	uint64_t value = 0;
+	for (int shift = 0; shift < 64 && !reader->overrun; shift += 4) {
+		uint64_t group = getBits(reader, 5);
+		value |= (group & 15) << shift;
+		if (!(group & 16)) {
+			break;
+		}
+	}
+	return value;
+}
+
+int bitsFor(uint64_t max_value) {
+	int bits = 0;
+	while (max_value >> bits) {
+		bits++;
+	}
+	return bits;
+}
+
+uint64_t zigzag(int value) {
+	return ((uint64_t)(int64_t)value << 1) ^ (uint64_t)((int64_t)value >> 63);
+}
+
+int unzigzag(uint64_t value) {
+	return (int)((int64_t)(value >> 1) ^ -(int64_t)(value & 1));
+}
+
+uint32_t floatBits(float value) {
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	return bits;
+}
+
+float bitsFloat(uint64_t bits) {
+	uint32_t low = (uint32_t)bits;
+	float value;
+	memcpy(&value, &low, sizeof(value));
+	return value;
+}
+
+
+
+//-------------------
+//-----SNAPSHOT------
+//-------------------
+// only what changes while playing is packed, the config and the board size
+// have to match on restore, and the map is rebuilt from the obstacle bits
+
+static const unsigned char car_types[] = { 0, CAR_WRAPPING, CAR_BOUNCING, CAR_DISAPPEARING };
+static const unsigned char car_interactions[] = { 0, CAR_PASSIVE, CAR_AGGRESSIVE, CAR_FRIENDLY };
+
+int kindIndex(unsigned char kind, const unsigned char* values) {
+	for (int i = 1; i < 4; i++) {
+		if (kind & values[i]) {
+			return i;
+		}
+	}
+	return 0;
+}
+
+void packGame(GameState* state, CarTable* cars, std::vector<unsigned char>* out) {
+	BitWriter writer;
+	writer.out = out;
+	out->clear();
+	putBits(&writer, SNAPSHOT_VERSION, 8);
+	putBitsVarint(&writer, (uint64_t)state->width);
+	putBitsVarint(&writer, (uint64_t)state->height);
+	putBitsVarint(&writer, (uint64_t)cars->count);
+
+	bool flags[] = { state->quit != 0, state->moveLeft, state->moveRight, state->moveUp, state->moveDown, state->obstaclesSet,
+		state->wDetected, state->aDetected, state->sDetected, state->dDetected, state->inputDetected, state->awaiting };
+	for (bool flag : flags) {
+		putBits(&writer, flag, 1);
+	}
+	putBits(&writer, (uint64_t)state->frog_x, bitsFor(state->width));
+	putBits(&writer, (uint64_t)state->frog_y, bitsFor(state->height));
+	putBits(&writer, (uint64_t)state->move, bitsFor(INPUT_ACTIONS));
+	putBits(&writer, (unsigned char)state->frog_symbol, 8);
+	putBits(&writer, floatBits(state->timer), 32);
+	putBits(&writer, floatBits(state->save_timer), 32);
+	putBits(&writer, floatBits(state->input_time), 32);
+	putBitsVarint(&writer, zigzag(state->points));
+	putBitsVarint(&writer, zigzag(state->highscore));
+	putBitsVarint(&writer, zigzag(state->collisionDetected));
+	putBitsVarint(&writer, zigzag(state->crossings));
+	putBitsVarint(&writer, zigzag(state->layout));
+	putBitsVarint(&writer, zigzag(state->r));
+	for (int i = 0; i < 4; i++) {
+		putBits(&writer, state->rng.s[i], 64);
+	}
+
+	//cars the last collision check stopped or left carrying the frog
+	CarIndex* index = &state->car_index;
+	int id_bits = bitsFor(cars->count);
+	putBitsVarint(&writer, (uint64_t)index->stopped_count);
+	for (int k = 0; k < index->stopped_count; k++) {
+		putBits(&writer, (uint64_t)index->stopped[k], id_bits);
+	}
+	putBitsVarint(&writer, (uint64_t)index->rider_count);
+	for (int k = 0; k < index->rider_count; k++) {
+		putBits(&writer, (uint64_t)index->riders[k], id_bits);
+	}
+
+	//one bit per cell of the separator rows, the only rows obstacles go on
+	if (state->obstaclesSet) {
+		for (int y = 2; y < state->height - 2; y += 2) {
+			for (int x = 1; x < state->width - 1; x++) {
+				putBits(&writer, (uint64_t)obstacleAt(state, y, x), 1);
+			}
+		}
+	}
+
+	//speed is always a whole 0..3 and direction -1/0/1, y and symbol follow from
+	//whether the car was ever placed, color from its interaction
+	int max_iters = 0;
+	for (int i = 0; i < cars->count; i++) {
+		if (cars->iters[i] > max_iters) {
+			max_iters = cars->iters[i];
+		}
+	}
+	int iter_bits = bitsFor((uint64_t)max_iters);
+	putBits(&writer, (uint64_t)iter_bits, 6);
+	for (int i = 0; i < cars->count; i++) {
+		putBits(&writer, floatBits(cars->x[i]), 32);
+		putBits(&writer, (uint64_t)cars->speed[i], 2);
+		putBits(&writer, (uint64_t)(cars->direction[i] + 1), 2);
+		putBits(&writer, cars->y[i] != 0, 1);
+		putBits(&writer, (uint64_t)kindIndex(cars->kind[i], car_types), 2);
+		putBits(&writer, (uint64_t)kindIndex(cars->kind[i], car_interactions), 2);
+		putBits(&writer, cars->flags[i], 3);
+		putBits(&writer, (uint64_t)cars->iters[i], iter_bits);
+	}
+	flushBits(&writer);
+}
+
+int unpackGame(const std::vector<unsigned char>* in, GameState* state, CarTable* cars) {
+	//state and cars must already be set up by initBoard/initCarTable with the same config
+	BitReader reader;
+	reader.in = in;
+	if (getBits(&reader, 8) != SNAPSHOT_VERSION ||
+		getBitsVarint(&reader) != (uint64_t)state->width ||
+		getBitsVarint(&reader) != (uint64_t)state->height ||
+		getBitsVarint(&reader) != (uint64_t)cars->count) {
+		return false;
+	}
+
+	bool* flags[] = { &state->moveLeft, &state->moveRight, &state->moveUp, &state->moveDown, &state->obstaclesSet,
+		&state->wDetected, &state->aDetected, &state->sDetected, &state->dDetected, &state->inputDetected, &state->awaiting };
+	state->quit = (int)getBits(&reader, 1);
+	for (bool* flag : flags) {
+		*flag = getBits(&reader, 1) != 0;
+	}
+	state->frog_x = (int)getBits(&reader, bitsFor(state->width));
+	state->frog_y = (int)getBits(&reader, bitsFor(state->height));
+	state->move = (int)getBits(&reader, bitsFor(INPUT_ACTIONS));
+	state->frog_symbol = (char)getBits(&reader, 8);
+	state->timer = bitsFloat(getBits(&reader, 32));
+	state->save_timer = bitsFloat(getBits(&reader, 32));
+	state->input_time = bitsFloat(getBits(&reader, 32));
+	state->points = unzigzag(getBitsVarint(&reader));
+	state->highscore = unzigzag(getBitsVarint(&reader));
+	state->collisionDetected = unzigzag(getBitsVarint(&reader));
+	state->crossings = unzigzag(getBitsVarint(&reader));
+	state->layout = unzigzag(getBitsVarint(&reader));
+	state->r = unzigzag(getBitsVarint(&reader));
+	for (int i = 0; i < 4; i++) {
+		state->rng.s[i] = getBits(&reader, 64);
+	}
+
+	CarIndex* index = &state->car_index;
+	int id_bits = bitsFor(cars->count);
+	index->stopped_count = (int)getBitsVarint(&reader);
+	for (int k = 0; k < index->stopped_count && k < cars->count; k++) {
+		index->stopped[k] = (int)getBits(&reader, id_bits);
+	}
+	index->rider_count = (int)getBitsVarint(&reader);
+	for (int k = 0; k < index->rider_count && k < cars->count; k++) {
+		index->riders[k] = (int)getBits(&reader, id_bits);
+	}
+
+	state->obstacles.assign(state->obstacles.size(), 0);
+	state->map.assign(state->map.size(), ' ');
+	if (state->obstaclesSet) {
+		//what buildMap would have left behind for this layout, without drawing new obstacles
+		setBordersAndSeparators(state);
+		for (int y = 2; y < state->height - 2; y += 2) {
+			for (int x = 1; x < state->width - 1; x++) {
+				if (getBits(&reader, 1)) {
+					setObstacleRun(state, y, x, 1);
+					state->map[y * state->width + x] = OBSTACLE_SYMBOL;
+				}
+			}
+		}
+		setFinishLane(state);
+	}
+
+	int iter_bits = (int)getBits(&reader, 6);
+	for (int i = 0; i < cars->count; i++) {
+		int lane = i / state->cars_per_lane;
+		cars->x[i] = bitsFloat(getBits(&reader, 32));
+		cars->speed[i] = (float)getBits(&reader, 2);
+		cars->direction[i] = (float)((int)getBits(&reader, 2) - 1);
+		bool placed = getBits(&reader, 1) != 0;
+		cars->y[i] = placed ? lane * 2 + 3 : 0;
+		cars->symbol[i] = placed ? state->car_symbol : ' ';
+		unsigned char type = car_types[getBits(&reader, 2)];
+		unsigned char interaction = car_interactions[getBits(&reader, 2)];
+		cars->kind[i] = type | interaction;
+		cars->color[i] = interaction == CAR_PASSIVE ? state->passive_car_color :
+			interaction == CAR_AGGRESSIVE ? state->aggressive_car_color :
+			interaction == CAR_FRIENDLY ? state->friendly_car_color : 0;
+		cars->flags[i] = (unsigned char)getBits(&reader, 3);
+		cars->iters[i] = (int)getBits(&reader, iter_bits);
+	}
+	return !reader.overrun && index->stopped_count <= cars->count && index->rider_count <= cars->count;
+}
+
+
+
+//-------------------
+//------REWIND-------
+//-------------------
+
+void initRewind(RewindRing* ring, int capacity) {
+	ring->slots = std::vector<RewindSlot>(capacity > 0 ? capacity : 1);
+	ring->head = 0;
+	ring->count = 0;
+	ring->requested = 0;
+}
+
+void pushRewind(RewindRing* ring, GameState* state, CarTable* cars, Replay* replay) {
+	//call before a tick, so popping it puts the game back to just before that tick
+	RewindSlot* slot = &ring->slots[ring->head];
+	packGame(state, cars, &slot->packed);
+	slot->mark.ticks = replay->ticks;
+	slot->mark.last_event_tick = replay->last_event_tick;
+	slot->mark.events = replay->events.size();
+	ring->head = (ring->head + 1) % (int)ring->slots.size();
+	if (ring->count < (int)ring->slots.size()) {
+		ring->count++;
+	}
+}
+
+int rewindTicks(RewindRing* ring, int ticks, GameState* state, CarTable* cars, Replay* replay) {
+	//the replay forgets the undone ticks as well, so it still plays back to the same game
+	int capacity = (int)ring->slots.size();
+	int undone = ticks < ring->count ? ticks : ring->count;
+	if (undone <= 0) {
+		return 0;
+	}
+	int head = (ring->head - undone + capacity) % capacity;
+	RewindSlot* slot = &ring->slots[head];
+	//unpack into copies, a bad snapshot must leave the game and the ring as they were
+	GameState restored = *state;
+	CarTable restored_cars = *cars;
+	if (!unpackGame(&slot->packed, &restored, &restored_cars)) {
+		return 0;
+	}
+	*state = restored;
+	*cars = restored_cars;
+	ring->head = head;
+	ring->count -= undone;
+	replay->ticks = slot->mark.ticks;
+	replay->last_event_tick = slot->mark.last_event_tick;
+	replay->events.resize(slot->mark.events);
+	return undone;
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+#include "game.h"
+#include "replay.h"
+
+#define REWIND_SECONDS			10 // how far back the rewind ring reaches
+#define REWIND_STEP_SECONDS		1 // rewound per key press
+
+
+
+//-------------------
+//------STRUCTS------
+//-------------------
+// appends values of any width up to 64 bits, least significant bit first
+typedef struct BitWriter {
+	std::vector<unsigned char>* out = nullptr;
+	uint64_t buffer = 0;
+	int bits = 0; // bits waiting in buffer, always < 8 between calls
+} BitWriter;
+
+typedef struct BitReader {
+	const std::vector<unsigned char>* in = nullptr;
+	size_t at = 0; // next byte of in
+	uint64_t buffer = 0;
+	int bits = 0;
+	bool overrun = false; // read past the end, the snapshot is damaged
+} BitReader;
+
+// where the replay stood when a snapshot was taken, so rewinding can cut the ticks off it too
+typedef struct ReplayMark {
+	long long ticks = 0;
+	long long last_event_tick = 0;
+	size_t events = 0;
+} ReplayMark;
+
+typedef struct RewindSlot {
+	std::vector<unsigned char> packed; // keeps its capacity, the ring stops allocating once warm
+	ReplayMark mark;
+} RewindSlot;
+
+// the last few seconds of ticks as packed snapshots, newest at head - 1
+typedef struct RewindRing {
+	std::vector<RewindSlot> slots;
+	int head = 0;
+	int count = 0;
+	int requested = 0; // rewind key presses not handled yet
+} RewindRing;
+
+
+
+//-------------------
+//----DECLARATIONS---
+//-------------------
+
+// Bit functions
+void putBits(BitWriter* writer, uint64_t value, int count);
+void putBitsVarint(BitWriter* writer, uint64_t value);
+void flushBits(BitWriter* writer);
+uint64_t getBits(BitReader* reader, int count);
+uint64_t getBitsVarint(BitReader* reader);
+int bitsFor(uint64_t max_value);
+uint64_t zigzag(int value);
+int unzigzag(uint64_t value);
+uint32_t floatBits(float value);
+float bitsFloat(uint64_t bits);
+
+// Snapshot functions
+int kindIndex(unsigned char kind, const unsigned char* values);
+void packGame(GameState* state, CarTable* cars, std::vector<unsigned char>* out);
+int unpackGame(const std::vector<unsigned char>* in, GameState* state, CarTable* cars);
+
+// Rewind functions
+void initRewind(RewindRing* ring, int capacity);
+void pushRewind(RewindRing* ring, GameState* state, CarTable* cars, Replay* replay);
+int rewindTicks(RewindRing* ring, int ticks, GameState* state, CarTable* cars, Replay* replay);
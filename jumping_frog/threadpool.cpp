@@ -0,0 +1,212 @@
+#include <deque>
+#include "threadpool.h"
+
+#define STEAL_CHUNK				16 // indices handed out per queue operation
+
+
+
+//-------------------
+//------STRUCTS------
+//-------------------
+// a range of task indices still to run
+typedef struct TaskRange {
+	long long begin = 0;
+	long long end = 0;
+} TaskRange;
+
+// every worker owns one queue, it pops from the back and thieves take from the front
+typedef struct WorkQueue {
+	std::mutex lock;
+	std::deque<TaskRange> ranges;
+} WorkQueue;
+
+typedef struct ThreadPool {
+	std::vector<WorkQueue> queues;
+	std::atomic<long long> remaining{ 0 };
+	ParallelTask task = nullptr;
+	void* context = nullptr;
+} ThreadPool;
+
+
+
+//-------------------
+//----DECLARATIONS---
+//-------------------
+int popLocal(ThreadPool* pool, int worker, TaskRange* range);
+int stealRange(ThreadPool* pool, int worker, TaskRange* range);
+void workerLoop(ThreadPool* pool, int worker);
+
+
+
+//-------------------
+//-------POOL--------
+//-------------------
+
+int defaultThreadCount() {
+	int threads = (int)std::thread::hardware_concurrency();
+	return threads > 0 ? threads : 1;
+}
+
+int popLocal(ThreadPool* pool, int worker, TaskRange* range) {
+	WorkQueue* queue = &pool->queues[worker];
+	std::lock_guard<std::mutex> guard(queue->lock);
+	if (queue->ranges.empty()) {
+		return false;
+	}
+	*range = queue->ranges.back();
+	queue->ranges.pop_back();
+	return true;
+}
+
+int stealRange(ThreadPool* pool, int worker, TaskRange* range) {
+	//walk the other queues starting next to our own, take the oldest range
+	//and split it so the victim keeps half of a large block
+	int count = (int)pool->queues.size();
+	for (int i = 1; i < count; i++) {
+		WorkQueue* victim = &pool->queues[(worker + i) % count];
+		std::lock_guard<std::mutex> guard(victim->lock);
+		if (victim->ranges.empty()) {
+			continue;
+		}
+		TaskRange* front = &victim->ranges.front();
+		long long size = front->end - front->begin;
+		if (size > 2 * STEAL_CHUNK) {
+			range->begin = front->begin;
+			range->end = front->begin + size / 2;
+			front->begin = range->end;
+		}
+		else {
+			*range = *front;
+			victim->ranges.pop_front();
+		}
+		return true;
+	}
+	return false;
+}
+
+void workerLoop(ThreadPool* pool, int worker) {
+	TaskRange range;
+	while (pool->remaining.load() > 0) {
+		if (!popLocal(pool, worker, &range) && !stealRange(pool, worker, &range)) {
+			std::this_thread::yield();
+			continue;
+		}
+		//run a small chunk and put the rest back where thieves can see it
+		if (range.end - range.begin > STEAL_CHUNK) {
+			TaskRange rest;
+			rest.begin = range.begin + STEAL_CHUNK;
+			rest.end = range.end;
+			range.end = rest.begin;
+			std::lock_guard<std::mutex> guard(pool->queues[worker].lock);
+			pool->queues[worker].ranges.push_back(rest);
+		}
+		for (long long i = range.begin; i < range.end; i++) {
+			pool->task(pool->context, i, worker);
+		}
+		pool->remaining -= range.end - range.begin;
+	}
+}
+
+void runParallel(int threads, long long count, ParallelTask task, void* context) {
+	if (threads < 1) {
+		threads = 1;
+	}
+	ThreadPool pool;
+	pool.queues = std::vector<WorkQueue>(threads);
+	pool.remaining = count;
+	pool.task = task;
+	pool.context = context;
+	//deal the index range out evenly, stealing evens out whatever runs long
+	for (int i = 0; i < threads; i++) {
+		TaskRange range;
+		range.begin = count * i / threads;
+		range.end = count * (i + 1) / threads;
+		if (range.end > range.begin) {
+			pool.queues[i].ranges.push_back(range);
+		}
+	}
+	std::vector<std::thread> workers;
+	for (int i = 1; i < threads; i++) {
+		workers.push_back(std::thread(workerLoop, &pool, i));
+	}
+	workerLoop(&pool, 0);
+	for (size_t i = 0; i < workers.size(); i++) {
+		workers[i].join();
+	}
+}
+
+
+
+//-------------------
+//----WORKER POOL----
+//-------------------
+
+void runPassIndices(WorkerPool* pool, int worker) {
+	long long count = pool->count;
+	long long begin;
+	while ((begin = pool->next.fetch_add(POOL_CHUNK)) < count) {
+		long long end = begin + POOL_CHUNK < count ? begin + POOL_CHUNK : count;
+		for (long long i = begin; i < end; i++) {
+			pool->task(pool->context, i, worker);
+		}
+	}
+}
+
+void poolWorker(WorkerPool* pool, int worker) {
+	//sleeps between passes, every thread takes part in every pass
+	long long seen = 0;
+	while (true) {
+		{
+			std::unique_lock<std::mutex> guard(pool->lock);
+			while (!pool->stop && pool->pass == seen) {
+				pool->wake.wait(guard);
+			}
+			if (pool->stop) {
+				return;
+			}
+			seen = pool->pass;
+		}
+		runPassIndices(pool, worker);
+		std::lock_guard<std::mutex> guard(pool->lock);
+		if (--pool->running == 0) {
+			pool->done.notify_one();
+		}
+	}
+}
+
+void startWorkerPool(WorkerPool* pool, int threads, ParallelTask task, void* context) {
+	//the caller is worker 0 of every pass, threads - 1 more are started here
+	pool->task = task;
+	pool->context = context;
+	for (int i = 1; i < threads; i++) {
+		pool->threads.push_back(std::thread(poolWorker, pool, i));
+	}
+}
+
+void runPass(WorkerPool* pool, long long count) {
+	{
+		std::lock_guard<std::mutex> guard(pool->lock);
+		pool->count = count;
+		pool->next = 0;
+		pool->running = (int)pool->threads.size();
+		pool->pass++;
+	}
+	pool->wake.notify_all();
+	runPassIndices(pool, 0);
+	std::unique_lock<std::mutex> guard(pool->lock);
+	while (pool->running > 0) {
+		pool->done.wait(guard);
+	}
+}
+
+void stopWorkerPool(WorkerPool* pool) {
+	{
+		std::lock_guard<std::mutex> guard(pool->lock);
+		pool->stop = true;
+	}
+	pool->wake.notify_all();
+	for (size_t i = 0; i < pool->threads.size(); i++) {
+		pool->threads[i].join();
+	}
+	pool->threads.clear();
+}
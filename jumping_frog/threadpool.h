@@ -0,0 +1,49 @@
+#pragma once
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+#include <atomic>
+
+#define POOL_CHUNK				4 // indices a worker pool thread takes per counter step
+
+// task body, called once for every index in [0, count), worker is the id of
+// the thread running it so callers can keep per-thread results without locks
+typedef void (*ParallelTask)(void* context, long long index, int worker);
+
+
+
+
+//-------------------
+//------STRUCTS------
+//-------------------
+// threads kept up between passes, for callers that run the same task every tick. A pass
+// hands [0, count) out through a shared counter and returns once every index ran
+typedef struct WorkerPool {
+	std::vector<std::thread> threads;
+	std::mutex lock;
+	std::condition_variable wake; // a pass started or the pool stops
+	std::condition_variable done; // the last worker left the pass
+	long long pass = 0; // passes started so far
+	long long count = 0; // indices in the current pass
+	std::atomic<long long> next{ 0 }; // first index not handed out yet
+	int running = 0; // threads still working on the current pass
+	bool stop = false;
+	ParallelTask task = nullptr;
+	void* context = nullptr;
+} WorkerPool;
+
+
+
+//-------------------
+//----DECLARATIONS---
+//-------------------
+int defaultThreadCount();
+void runParallel(int threads, long long count, ParallelTask task, void* context);
+
+// Worker pool functions
+void runPassIndices(WorkerPool* pool, int worker);
+void poolWorker(WorkerPool* pool, int worker);
+void startWorkerPool(WorkerPool* pool, int threads, ParallelTask task, void* context);
+void runPass(WorkerPool* pool, long long count);
+void stopWorkerPool(WorkerPool* pool);
@@ -0,0 +1,219 @@
+#include <stdio.h>
+#include <vector>
+#include "headless.h"
+#include "clock.h"
+#include "threadpool.h"
+
+#define HISTOGRAM_BAR_WIDTH		40
+
+
+
+//-------------------
+//------STRUCTS------
+//-------------------
+typedef struct BatchContext {
+	const GameState* base = nullptr;
+	uint64_t seed = 0;
+	std::vector<BatchStats> workers;
+	std::vector<Bot> bots; // one per worker when the bot plays, empty otherwise
+} BatchContext;
+
+
+
+//-------------------
+//----DECLARATIONS---
+//-------------------
+void batchTask(void* context, long long index, int worker);
+
+
+
+//-------------------
+//-----HISTOGRAM-----
+//-------------------
+
+void initHistogram(Histogram* histogram, const char* name, double min, double bucket_width) {
+	*histogram = Histogram();
+	histogram->name = name;
+	histogram->min = min;
+	histogram->bucket_width = bucket_width > 0.0 ? bucket_width : 1.0;
+}
+
+void addSample(Histogram* histogram, double value) {
+	int bucket = (int)((value - histogram->min) / histogram->bucket_width);
+	if (value < histogram->min) {
+		histogram->below++;
+	}
+	else if (bucket >= HISTOGRAM_BUCKETS) {
+		histogram->above++;
+	}
+	else {
+		histogram->buckets[bucket]++;
+	}
+	if (histogram->count == 0 || value > histogram->max) {
+		histogram->max = value;
+	}
+	histogram->count++;
+	histogram->sum += value;
+}
+
+void mergeHistogram(Histogram* into, const Histogram* from) {
+	for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+		into->buckets[i] += from->buckets[i];
+	}
+	into->below += from->below;
+	into->above += from->above;
+	if (from->count > 0 && (into->count == 0 || from->max > into->max)) {
+		into->max = from->max;
+	}
+	into->count += from->count;
+	into->sum += from->sum;
+}
+
+void printHistogram(const Histogram* histogram) {
+	long long peak = 1;
+	for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+		if (histogram->buckets[i] > peak) {
+			peak = histogram->buckets[i];
+		}
+	}
+	printf("\n%s: %lld samples, mean %.2f, max %.2f\n", histogram->name, histogram->count,
+		histogram->count > 0 ? histogram->sum / histogram->count : 0.0, histogram->max);
+	if (histogram->below > 0) {
+		printf("  %8s  < %-8.1f %10lld\n", "", histogram->min, histogram->below);
+	}
+	for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+		double from = histogram->min + i * histogram->bucket_width;
+		printf("  %8.1f .. %-8.1f %10lld ", from, from + histogram->bucket_width, histogram->buckets[i]);
+		for (long long j = 0; j < histogram->buckets[i] * HISTOGRAM_BAR_WIDTH / peak; j++) {
+			putchar('#');
+		}
+		putchar('\n');
+	}
+	if (histogram->above > 0) {
+		printf("  %8s >= %-8.1f %10lld\n", "", histogram->min + HISTOGRAM_BUCKETS * histogram->bucket_width, histogram->above);
+	}
+}
+
+
+
+//-------------------
+//-------BATCH-------
+//-------------------
+
+void initBatchStats(BatchStats* stats, const GameState* base) {
+	double max_time = base->max_time > 0 ? base->max_time : 1;
+	initHistogram(&stats->score, "score at end of round", 0.0, 10.0);
+	initHistogram(&stats->collisions, "collisions per round", 0.0, 1.0);
+	initHistogram(&stats->finish_time, "seconds to reach the finish lane", 0.0, max_time / HISTOGRAM_BUCKETS);
+	stats->games = 0;
+	stats->ticks = 0;
+}
+
+void playRound(GameState* state, CarTable* cars, Rng* input_rng, Bot* bot, BatchStats* stats) {
+	//one round lasts until resetGame rewinds the timer, the tick limit only
+	//guards against a config that never ends a round
+	long long max_ticks = (long long)((state->max_time + 1) / TIMER_ADDITION) + 1;
+	float last_crossing = 0;
+	for (long long t = 0; t < max_ticks && state->quit; t++) {
+		InputEvent input;
+		if (bot != NULL) {
+			botInput(bot, state, cars, &input);
+		}
+		else {
+			randomInput(&input, input_rng);
+		}
+		float timer = state->timer;
+		int points = state->points;
+		int collisions = state->collisionDetected;
+		int crossings = state->crossings;
+		stepGame(state, cars, &input, 1);
+		stats->ticks++;
+		if (state->timer < timer) {
+			addSample(&stats->score, points);
+			addSample(&stats->collisions, collisions);
+			break;
+		}
+		if (state->crossings > crossings) {
+			addSample(&stats->finish_time, state->timer - last_crossing);
+			last_crossing = state->timer;
+		}
+	}
+	stats->games++;
+}
+
+uint64_t seedBatchGame(GameState* state, uint64_t seed, long long index) {
+	//every game gets its own streams and layouts, so results don't depend on which thread
+	//ran it and a batch doesn't play one layout over and over; the input stream is stream + 1
+	uint64_t stream = (seed << 32) + 2 * (uint64_t)index;
+	uint64_t mix = stream;
+	seedRng(&state->rng, stream);
+	state->seed = (int)(splitMix64(&mix) & 0x7fffffff);
+	if (state->seed == 0) {
+		state->seed = 1; // 0 would mean seeded from the clock
+	}
+	//a cache or a taken level would still hold the layouts of base's seed
+	state->levels = nullptr;
+	state->obstaclesSet = false;
+	return stream;
+}
+
+void batchTask(void* context, long long index, int worker) {
+	BatchContext* batch = (BatchContext*)context;
+	//the copy gets its own grids, only the config comes from base
+	GameState state = *batch->base;
+	CarTable cars;
+	initCarTable(&cars, state.car_count);
+	Rng input_rng;
+	uint64_t stream = seedBatchGame(&state, batch->seed, index);
+	seedRng(&input_rng, stream + 1);
+	Bot* bot = batch->bots.empty() ? NULL : &batch->bots[worker];
+	playRound(&state, &cars, &input_rng, bot, &batch->workers[worker]);
+}
+
+void runBatch(HeadlessOptions* options, const GameState* base) {
+	BatchContext batch;
+	BatchStats total;
+	int threads = options->threads > 0 ? options->threads : defaultThreadCount();
+	batch.base = base;
+	batch.seed = options->seed;
+	batch.workers = std::vector<BatchStats>(threads);
+	for (int i = 0; i < threads; i++) {
+		initBatchStats(&batch.workers[i], base);
+	}
+	if (options->bot_input) {
+		//the bot only keeps scratch between plans, a worker can reuse it for every game
+		batch.bots = std::vector<Bot>(threads);
+		for (int i = 0; i < threads; i++) {
+			initBot(&batch.bots[i], base, options->bot_horizon, options->bot_budget_us);
+		}
+	}
+	initBatchStats(&total, base);
+
+	double start = clockNow();
+	runParallel(threads, options->games, batchTask, &batch);
+	double seconds = clockNow() - start;
+
+	for (int i = 0; i < threads; i++) {
+		mergeHistogram(&total.score, &batch.workers[i].score);
+		mergeHistogram(&total.collisions, &batch.workers[i].collisions);
+		mergeHistogram(&total.finish_time, &batch.workers[i].finish_time);
+		total.games += batch.workers[i].games;
+		total.ticks += batch.workers[i].ticks;
+	}
+	printf("games:       %lld\n", total.games);
+	printf("threads:     %d\n", threads);
+	printf("seconds:     %.3f\n", seconds);
+	printf("games/s:     %.0f\n", seconds > 0.0 ? total.games / seconds : 0.0);
+	printf("ticks/s:     %.0f\n", seconds > 0.0 ? total.ticks / seconds : 0.0);
+	printHistogram(&total.score);
+	printHistogram(&total.collisions);
+	printHistogram(&total.finish_time);
+	if (options->bot_input) {
+		Bot bots;
+		for (int i = 0; i < threads; i++) {
+			mergeBotStats(&bots, &batch.bots[i]);
+		}
+		printf("\n");
+		printBotStats(&bots);
+	}
+}
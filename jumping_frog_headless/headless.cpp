@@ -0,0 +1,442 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "headless.h"
+#include "config.h"
+#include "clock.h"
+
+
+
+//-------------------
+//----DECLARATIONS---
+//-------------------
+void printUsage(const char* program);
+int parseOptions(int argc, char** argv, HeadlessOptions* options);
+void runHeadless(HeadlessOptions* options, HeadlessStats* stats, GameState* state, CarTable* cars, Replay* replay);
+void printStats(HeadlessStats* stats, GameState* state);
+
+
+
+//-------------------
+//------OPTIONS------
+//-------------------
+
+void printUsage(const char* program) {
+	printf("usage: %s [--ticks N] [--config FILE] [--input none|random|bot] [--seed N]\n", program);
+	printf("       %*s [--bot-budget US] [--bot-horizon TICKS]\n", (int)strlen(program), "");
+	printf("       %*s [--batch GAMES] [--threads N] [--set key=value]...\n", (int)strlen(program), "");
+	printf("       %*s [--record FILE] [--replay FILE [--seek TICK]] [--bench-cars MAX_CARS]\n", (int)strlen(program), "");
+	printf("       %*s [--serve SESSIONS [--port N] [--players N]] [--check-levels SEEDS]\n", (int)strlen(program), "");
+}
+
+int parseOptions(int argc, char** argv, HeadlessOptions* options) {
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--ticks") == 0 && i + 1 < argc) {
+			options->ticks = atoll(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--config") == 0 && i + 1 < argc) {
+			options->config = argv[++i];
+		}
+		else if (strcmp(argv[i], "--input") == 0 && i + 1 < argc) {
+			i++;
+			options->random_input = strcmp(argv[i], "random") == 0;
+			options->bot_input = strcmp(argv[i], "bot") == 0;
+			if (!options->random_input && !options->bot_input && strcmp(argv[i], "none") != 0) {
+				return false;
+			}
+		}
+		else if (strcmp(argv[i], "--bot-budget") == 0 && i + 1 < argc) {
+			options->bot_budget_us = atof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--bot-horizon") == 0 && i + 1 < argc) {
+			options->bot_horizon = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+			options->seed = strtoull(argv[++i], NULL, 10) & 0x7fffffff;
+			options->seeded = true;
+		}
+		else if (strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
+			options->games = atoll(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+			options->threads = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+			options->record = argv[++i];
+		}
+		else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+			options->replay = argv[++i];
+		}
+		else if (strcmp(argv[i], "--seek") == 0 && i + 1 < argc) {
+			options->seek = atoll(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--serve") == 0 && i + 1 < argc) {
+			options->sessions = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+			options->port = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--players") == 0 && i + 1 < argc) {
+			options->players = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--bench-cars") == 0 && i + 1 < argc) {
+			options->bench_cars = atoll(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--check-levels") == 0 && i + 1 < argc) {
+			options->check_levels = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--set") == 0 && i + 1 < argc && options->override_count < MAX_OVERRIDES) {
+			options->overrides[options->override_count++] = argv[++i];
+		}
+		else {
+			return false;
+		}
+	}
+	return true;
+}
+
+int applyOverrides(HeadlessOptions* options, GameState* state) {
+	//same key=value syntax as config.txt, so a sweep can vary any setting
+	for (int i = 0; i < options->override_count; i++) {
+		const char* override = options->overrides[i];
+		const char* equals = strchr(override, '=');
+		if (equals == NULL) {
+			fprintf(stderr, "bad override %s, expected key=value\n", override);
+			return false;
+		}
+		ConfigReport report;
+		parseConfigText(override, strlen(override), state, false, &report);
+		if (report.errors > 0) {
+			fprintf(stderr, "bad override %s, %s\n", override, report.message);
+			return false;
+		}
+	}
+	return true;
+}
+
+
+
+//-------------------
+//------DRIVER-------
+//-------------------
+
+void randomInput(InputEvent* input, Rng* rng) {
+	//mostly forward so the frog actually reaches the finish lane now and then
+	static const int actions[] = { INPUT_UP, INPUT_UP, INPUT_UP, INPUT_DOWN, INPUT_LEFT, INPUT_RIGHT, INPUT_PICK_UP };
+	if (randomBelow(rng, RANDOM_INPUT_CHANCE) == 0) {
+		input->action = actions[randomBelow(rng, sizeof(actions) / sizeof(actions[0]))];
+	}
+}
+
+void runHeadless(HeadlessOptions* options, HeadlessStats* stats, GameState* state, CarTable* cars, Replay* replay) {
+	Rng input_rng;
+	Bot bot;
+	seedRng(&input_rng, options->seed + 1);
+	if (options->bot_input) {
+		initBot(&bot, state, options->bot_horizon, options->bot_budget_us);
+	}
+	double start = clockNow();
+	for (long long t = 0; t < options->ticks && state->quit; t++) {
+		InputEvent input;
+		if (options->bot_input) {
+			botInput(&bot, state, cars, &input);
+		}
+		else if (options->random_input) {
+			randomInput(&input, &input_rng);
+		}
+		float timer = state->timer;
+		int collisions = state->collisionDetected;
+		int points = state->points;
+		if (replay != NULL) {
+			recordTick(replay, &input, input.action != INPUT_NONE);
+		}
+		stepGame(state, cars, &input, 1);
+		//resetGame rewinds the timer when a round ends
+		if (state->timer < timer) {
+			stats->rounds++;
+			stats->collisions += collisions;
+			stats->points += points;
+		}
+		stats->ticks++;
+	}
+	stats->seconds = clockNow() - start;
+	if (options->bot_input) {
+		printBotStats(&bot);
+	}
+}
+
+void printStats(HeadlessStats* stats, GameState* state) {
+	printf("ticks:       %lld\n", stats->ticks);
+	printf("seconds:     %.3f\n", stats->seconds);
+	printf("ticks/s:     %.0f\n", stats->seconds > 0.0 ? stats->ticks / stats->seconds : 0.0);
+	printf("game time:   %.1f s\n", stats->ticks * TIMER_ADDITION);
+	printf("rounds:      %lld\n", stats->rounds);
+	printf("collisions:  %lld\n", stats->collisions);
+	printf("points:      %lld\n", stats->points);
+	printf("highscore:   %d\n", state->highscore);
+}
+
+
+
+//-------------------
+//------REPLAY-------
+//-------------------
+
+void printPlayerState(ReplayPlayer* player) {
+	printf("tick:        %lld\n", player->tick);
+	printf("time:        %.2f s\n", player->state.timer);
+	printf("points:      %d\n", player->state.points);
+	printf("highscore:   %d\n", player->state.highscore);
+	printf("frog:        %d,%d\n", player->state.frog_x, player->state.frog_y);
+}
+
+int runReplay(HeadlessOptions* options) {
+	Replay replay;
+	ReplayPlayer player;
+	if (!loadReplay(&replay, options->replay)) {
+		fprintf(stderr, "cannot read replay %s\n", options->replay);
+		return false;
+	}
+	initPlayer(&player, &replay);
+	printf("seed:        %d\n", replay.seed);
+	printf("board:       %dx%d, %d cars\n", player.state.width, player.state.height, player.state.car_count);
+
+	double start = clockNow();
+	seekPlayer(&player, replay.ticks);
+	double seconds = clockNow() - start;
+	double tick_rate = player.state.tick_rate > 0 ? player.state.tick_rate : DEFAULT_TICK_RATE;
+	bool same = replay.checksum == gameChecksum(&player.state, &player.cars);
+	printPlayerState(&player);
+	printf("seconds:     %.3f\n", seconds);
+	printf("speed:       %.0fx real time\n", seconds > 0.0 ? replay.ticks / tick_rate / seconds : 0.0);
+	printf("snapshots:   %zu\n", player.snapshots.size());
+	printf("checksum:    %08x %s\n", gameChecksum(&player.state, &player.cars), same ? "matches the recording" : "DIFFERS from the recording");
+
+	if (options->seek >= 0) {
+		start = clockNow();
+		seekPlayer(&player, options->seek);
+		seconds = clockNow() - start;
+		printf("\nseek to %lld took %.3f ms\n", options->seek, seconds * 1e3);
+		printPlayerState(&player);
+	}
+	return same;
+}
+
+
+
+//-------------------
+//-----BENCHMARK-----
+//-------------------
+
+void randomCarTable(CarTable* cars, int count, GameState* state, Rng* rng) {
+	static const unsigned char types[] = { CAR_WRAPPING, CAR_BOUNCING, CAR_DISAPPEARING };
+	static const unsigned char interactions[] = { CAR_PASSIVE, CAR_AGGRESSIVE, CAR_FRIENDLY };
+	initCarTable(cars, count);
+	for (int i = 0; i < count; i++) {
+		cars->x[i] = (float)(nextRandom(rng) % (state->width * 100)) / 100;
+		cars->speed[i] = randomBelow(rng, 3) + 1;
+		cars->direction[i] = randomBelow(rng, 2) ? 1 : -1;
+		cars->kind[i] = types[randomBelow(rng, 3)] | interactions[randomBelow(rng, 3)];
+		cars->flags[i] = CAR_INITIALIZED;
+		if (randomBelow(rng, BENCH_STOPPED_CHANCE) == 0) {
+			cars->flags[i] |= CAR_STOPPED;
+		}
+	}
+}
+
+void respawnCars(CarTable* cars, GameState* state) {
+	//stands in for initializeCars, a car that disappeared or ran out of
+	//bounces starts again from the edge it is heading away from
+	for (int i = 0; i < cars->count; i++) {
+		if (!(cars->flags[i] & CAR_INITIALIZED)) {
+			cars->x[i] = cars->direction[i] > 0 ? 2 : state->width - 2;
+			cars->flags[i] |= CAR_INITIALIZED;
+		}
+	}
+}
+
+void moveCarsScalarOnly(CarTable* cars, GameState* state) {
+	moveCarsScalar(cars, 0, cars->count, state);
+	respawnCars(cars, state);
+}
+
+void moveCarsAndRespawn(CarTable* cars, GameState* state) {
+	moveCars(cars, state);
+	respawnCars(cars, state);
+}
+
+double timeMoveCars(void (*move)(CarTable*, GameState*), CarTable* cars, GameState* state, int steps) {
+	double start = clockNow();
+	for (int i = 0; i < steps; i++) {
+		move(cars, state);
+	}
+	return clockNow() - start;
+}
+
+void runCarBenchmark(long long max_cars, GameState* state) {
+	//same starting table for both paths, the tables have to match afterwards
+	Rng rng;
+	seedRng(&rng, (uint64_t)state->seed);
+	printf("%10s %8s %14s %14s %8s\n", "cars", "steps", "scalar ns/car", "kernel ns/car", "speedup");
+	for (long long count = 10000; count <= max_cars; count *= 10) {
+		CarTable scalar;
+		randomCarTable(&scalar, (int)count, state, &rng);
+		CarTable kernel = scalar;
+		int steps = (int)(BENCH_CAR_UPDATES / count);
+		double scalar_seconds = timeMoveCars(moveCarsScalarOnly, &scalar, state, steps);
+		double kernel_seconds = timeMoveCars(moveCarsAndRespawn, &kernel, state, steps);
+		bool same = scalar.x == kernel.x && scalar.direction == kernel.direction &&
+			scalar.iters == kernel.iters && scalar.flags == kernel.flags;
+		printf("%10lld %8d %14.3f %14.3f %7.1fx%s\n", count, steps,
+			scalar_seconds * 1e9 / ((double)count * steps), kernel_seconds * 1e9 / ((double)count * steps),
+			kernel_seconds > 0.0 ? scalar_seconds / kernel_seconds : 0.0, same ? "" : "  MISMATCH");
+	}
+}
+
+
+
+//-------------------
+//----LEVEL CHECK----
+//-------------------
+
+int levelCrossable(const LevelParams* params, const uint64_t* obstacles) {
+	//every separator row needs a cell the frog can stand on, x in [2, width-2], and the
+	//finish lane has to be reachable from the start
+	for (int y = 2; y < params->height - 2; y += 2) {
+		const uint64_t* row = &obstacles[y * params->row_words];
+		int free_cells = 0;
+		for (int x = 2; x <= params->width - 2; x++) {
+			free_cells += !((row[x >> 6] >> (x & 63)) & 1);
+		}
+		if (free_cells == 0) {
+			return false;
+		}
+	}
+	return levelReachable(params, obstacles);
+}
+
+int runLevelCheck(int seeds, GameState* state) {
+	//generates the first levels of seeds 1..seeds over a few widths and obstacle counts,
+	//every one of them has to be crossable
+	static const int widths[] = { MIN_BOARD_WIDTH, DEFAULT_BOARD_WIDTH, LEVEL_CHECK_WIDE };
+	LevelParams params;
+	levelParams(state, &params);
+	params.obstacle_ramp = LEVEL_CHECK_RAMP;
+	std::vector<uint64_t> obstacles;
+	long long levels = 0;
+	long long failed = 0;
+	for (int w = 0; w < (int)(sizeof(widths) / sizeof(widths[0])); w++) {
+		params.width = widths[w];
+		params.row_words = (params.width + 63) / 64;
+		for (int count = 5; count <= 40; count += 5) {
+			params.obstacle_count = count;
+			for (int seed = 1; seed <= seeds; seed++) {
+				params.seed = seed;
+				for (int number = 0; number < LEVEL_CHECK_LEVELS; number++) {
+					generateLevel(&params, number, &obstacles);
+					levels++;
+					if (!levelCrossable(&params, obstacles.data())) {
+						if (failed < 10) {
+							printf("not crossable: width %d, %d obstacles, seed %d, level %d\n",
+								params.width, count, seed, number);
+						}
+						failed++;
+					}
+				}
+			}
+		}
+	}
+	printf("levels:      %lld checked, %lld not crossable\n", levels, failed);
+	return failed == 0;
+}
+
+int runLayoutCheck(int games, const GameState* base) {
+	//neighbouring batch games and server sessions must not share a first layout
+	long long same = 0;
+	std::vector<uint64_t> previous;
+	for (int index = 0; index <= games; index++) {
+		GameState state = *base;
+		seedBatchGame(&state, (uint64_t)base->seed, index);
+		takeLevel(&state);
+		if (index > 0 && state.obstacles == previous) {
+			if (same < 10) {
+				printf("same layout: games %d and %d\n", index - 1, index);
+			}
+			same++;
+		}
+		previous.swap(state.obstacles);
+	}
+	printf("layouts:     %d game pairs checked, %lld share a layout\n", games, same);
+	return same == 0;
+}
+
+
+
+//-------------------
+//-------MAIN--------
+//-------------------
+
+int main(int argc, char** argv) {
+	HeadlessOptions options;
+	HeadlessStats stats;
+	GameState state;
+	if (!parseOptions(argc, argv, &options)) {
+		printUsage(argv[0]);
+		return 1;
+	}
+	if (options.replay != NULL) {
+		return runReplay(&options) ? 0 : 1;
+	}
+	ConfigReport report;
+	if (!readConfigFile(options.config, &state, &report)) {
+		fprintf(stderr, "cannot open config file %s\n", options.config);
+		return 1;
+	}
+	if (report.errors > 0) {
+		fprintf(stderr, "config: %d problem(s), %s\n", report.errors, report.message);
+	}
+	if (!applyOverrides(&options, &state)) {
+		return 1;
+	}
+	//--seed wins over seed= in the config, with neither the clock picks one
+	if (options.seeded) {
+		state.seed = (int)options.seed;
+	}
+	initBoard(&state);
+	seedGame(&state);
+	options.seed = (uint64_t)state.seed;
+	printf("seed:        %d\n", state.seed);
+	printf("board:       %dx%d, %d cars\n", state.width, state.height, state.car_count);
+	if (options.bench_cars > 0) {
+		runCarBenchmark(options.bench_cars, &state);
+		return 0;
+	}
+	if (options.check_levels > 0) {
+		int crossable = runLevelCheck(options.check_levels, &state);
+		int distinct = runLayoutCheck(options.check_levels, &state);
+		return crossable && distinct ? 0 : 1;
+	}
+	if (options.games > 0) {
+		runBatch(&options, &state);
+		return 0;
+	}
+	if (options.sessions > 0) {
+		runServer(&options, &state);
+		return 0;
+	}
+	CarTable cars;
+	Replay replay;
+	initCarTable(&cars, state.car_count);
+	startReplay(&replay, &state);
+	runHeadless(&options, &stats, &state, &cars, options.record != NULL ? &replay : NULL);
+	printStats(&stats, &state);
+	if (options.record != NULL) {
+		finishReplay(&replay, &state, &cars);
+		if (!saveReplay(&replay, options.record)) {
+			fprintf(stderr, "cannot write replay %s\n", options.record);
+			return 1;
+		}
+		printf("replay:      %s, %zu bytes of input\n", options.record, replay.events.size());
+	}
+	return 0;
+}
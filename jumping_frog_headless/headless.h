@@ -0,0 +1,114 @@
+#pragma once
+#include <stdint.h>
+#include "game.h"
+#include "replay.h"
+#include "bot.h"
+#include "levels.h"
+
+#define DEFAULT_TICKS			10000000
+#define RANDOM_INPUT_CHANCE		8 // on average one key every this many ticks
+#define MAX_OVERRIDES			32
+#define HISTOGRAM_BUCKETS		20
+#define BENCH_CAR_UPDATES		200000000 // car moves timed per table size and path
+#define BENCH_STOPPED_CHANCE	20 // one car in this many is stopped for the frog
+#define SERVER_PORT				7878
+#define LEVEL_CHECK_LEVELS		10 // levels generated per seed, width and obstacle count
+#define LEVEL_CHECK_RAMP		3 // extra obstacle runs per level in the check
+#define LEVEL_CHECK_WIDE		200 // widest board in the check, rows span several words
+
+
+
+//-------------------
+//------STRUCTS------
+//-------------------
+typedef struct HeadlessOptions {
+	long long ticks = DEFAULT_TICKS;
+	const char* config = "config.txt";
+	bool random_input = true;
+	bool bot_input = false; // the bot plays instead of random keys
+	int bot_horizon = BOT_HORIZON;
+	double bot_budget_us = BOT_BUDGET_US; // 0 - unlimited, the run is repeatable
+	uint64_t seed = 0;
+	bool seeded = false;
+	long long games = 0; // > 0 - batch mode
+	int threads = 0; // 0 - one per core
+	const char* overrides[MAX_OVERRIDES] = { NULL }; // key=value pairs applied over the config
+	int override_count = 0;
+	long long bench_cars = 0; // > 0 - time moveCars on tables of 10k cars up to this many
+	const char* record = NULL; // write the run's replay here
+	const char* replay = NULL; // play this replay back instead of simulating
+	long long seek = -1; // >= 0 - after playback, seek the replay to this tick
+	int sessions = 0; // > 0 - server mode, host this many games
+	int port = SERVER_PORT;
+	int players = 0; // stand-in players the server connects to itself over loopback
+	int check_levels = 0; // > 0 - check the levels of this many seeds can all be crossed
+} HeadlessOptions;
+
+typedef struct HeadlessStats {
+	long long ticks = 0;
+	long long rounds = 0;
+	long long collisions = 0;
+	long long points = 0;
+	double seconds = 0.0;
+} HeadlessStats;
+
+// fixed-width buckets starting at min, values outside land in below/above
+typedef struct Histogram {
+	const char* name = "";
+	double min = 0.0;
+	double bucket_width = 1.0;
+	long long buckets[HISTOGRAM_BUCKETS] = { 0 };
+	long long below = 0;
+	long long above = 0;
+	long long count = 0;
+	double sum = 0.0;
+	double max = 0.0;
+} Histogram;
+
+typedef struct BatchStats {
+	Histogram score;
+	Histogram collisions;
+	Histogram finish_time; // game seconds between two crossings of the finish lane
+	long long games = 0;
+	long long ticks = 0;
+} BatchStats;
+
+
+
+//-------------------
+//----DECLARATIONS---
+//-------------------
+
+// Driver functions
+void randomInput(InputEvent* input, Rng* rng);
+int applyOverrides(HeadlessOptions* options, GameState* state);
+
+// Replay functions
+void printPlayerState(ReplayPlayer* player);
+int runReplay(HeadlessOptions* options);
+
+// Benchmark functions
+void randomCarTable(CarTable* cars, int count, GameState* state, Rng* rng);
+double timeMoveCars(void (*move)(CarTable*, GameState*), CarTable* cars, GameState* state, int steps);
+void respawnCars(CarTable* cars, GameState* state);
+void moveCarsScalarOnly(CarTable* cars, GameState* state);
+void moveCarsAndRespawn(CarTable* cars, GameState* state);
+void runCarBenchmark(long long max_cars, GameState* state);
+
+// Level check functions
+int levelCrossable(const LevelParams* params, const uint64_t* obstacles);
+int runLevelCheck(int seeds, GameState* state);
+int runLayoutCheck(int games, const GameState* base);
+
+// Batch functions
+void initHistogram(Histogram* histogram, const char* name, double min, double bucket_width);
+void addSample(Histogram* histogram, double value);
+void mergeHistogram(Histogram* into, const Histogram* from);
+void printHistogram(const Histogram* histogram);
+void initBatchStats(BatchStats* stats, const GameState* base);
+void playRound(GameState* state, CarTable* cars, Rng* input_rng, Bot* bot, BatchStats* stats);
+uint64_t seedBatchGame(GameState* state, uint64_t seed, long long index);
+void runBatch(HeadlessOptions* options, const GameState* base);
+
+// Server functions
+void runServer(HeadlessOptions* options, const GameState* base);
@@ -0,0 +1,571 @@
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#if defined(_WIN32)
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+#else
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+#include "headless.h"
+#include "clock.h"
+#include "input.h"
+#include "profiler.h"
+#include "threadpool.h"
+
+#if defined(_WIN32)
+typedef SOCKET Socket;
+#define poll					WSAPoll
+#else
+typedef int Socket;
+#define INVALID_SOCKET			-1
+#endif
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL			0
+#endif
+
+#define SERVER_KEYS				" wsad qn" // the key byte for every action from INPUT_UP on
+#define SERVER_FRAME_END		'\f' // ends every frame sent to a player
+#define SERVER_READ_SIZE		4096
+#define SERVER_INFO_SIZE		64
+#define SERVER_BACKLOG			64
+#define SERVER_REPORT_ROWS		16 // sessions listed one by one, the rest only in the total
+#define PLAYER_POLL_MS			100 // how often a stand-in player checks if the server stopped
+
+
+
+//-------------------
+//------STRUCTS------
+//-------------------
+// one hosted game and the player connected to it, if any
+typedef struct Session {
+	GameState state;
+	CarTable cars;
+	InputQueue queue;
+	Socket socket = INVALID_SOCKET;
+	std::string frame; // rendered by the last pass, not sent yet
+	std::string out; // the part of a frame the socket did not take yet
+	long long players = 0; // connections served so far
+	long long frames_sent = 0;
+	long long frames_dropped = 0; // rendered while the previous frame was still going out
+	Profiler profiler; // PHASE_SIMULATE, PHASE_BUILD_FRAME, PHASE_INPUT_LATENCY - key read until its frame was sent
+} Session;
+
+// every session steps on one shared clock, the ticks due in a pass are run for
+// all sessions by the worker pool, the network is only touched between passes
+typedef struct Server {
+	const GameState* base = nullptr;
+	uint64_t seed = 0;
+	int port = SERVER_PORT;
+	Socket listener = INVALID_SOCKET;
+	SimClock clock;
+	std::vector<Session> sessions;
+	std::vector<double> tick_accumulators; // clock.accumulator right after each tick of this pass
+	bool render = false; // the pass ends with a frame for every session
+	long long rejected = 0; // connections turned away, every session had a player
+	Profiler profiler; // PHASE_SIMULATE - one pass over every session
+	Profiler players; // PHASE_INPUT_LATENCY - key sent until the next frame arrived, as the players saw it
+	std::atomic<bool> stop{ false };
+	WorkerPool workers; // up for the whole run, one pass per tick or frame
+} Server;
+
+
+
+//-------------------
+//----DECLARATIONS---
+//-------------------
+
+// Socket functions
+int initSockets();
+void closeSocket(Socket socket);
+int wouldBlock();
+void setNonBlocking(Socket socket);
+Socket openListener(int port);
+Socket connectLocal(int port);
+
+// Session functions
+int byteToAction(char key);
+char actionToByte(int action);
+void resetSession(Server* server, int index);
+void renderSession(Session* session);
+void sessionTask(void* context, long long index, int worker);
+
+// Network functions
+void acceptPlayers(Server* server);
+int readKeys(Session* session);
+int flushFrame(Session* session);
+void dropPlayer(Server* server, int index);
+void pollServer(Server* server, int timeout_ms);
+
+// Player functions
+void playerLoop(Server* server, int index);
+
+// Report functions
+void mergePhase(PhaseHistogram* into, const PhaseHistogram* from);
+void printPhase(const char* name, const PhaseHistogram* histogram);
+void printServerStats(Server* server, int threads, int players, double seconds);
+
+
+
+//-------------------
+//------SOCKETS------
+//-------------------
+
+int initSockets() {
+#if defined(_WIN32)
+	WSADATA data;
+	return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+#else
+	return true;
+#endif
+}
+
+void closeSocket(Socket socket) {
+#if defined(_WIN32)
+	closesocket(socket);
+#else
+	close(socket);
+#endif
+}
+
+int wouldBlock() {
+#if defined(_WIN32)
+	return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+	return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+}
+
+void setNonBlocking(Socket socket) {
+#if defined(_WIN32)
+	u_long on = 1;
+	ioctlsocket(socket, FIONBIO, &on);
+#else
+	fcntl(socket, F_SETFL, fcntl(socket, F_GETFL, 0) | O_NONBLOCK);
+#endif
+	//frames are small and latency is what is measured, don't let them wait for a full packet
+	int nodelay = 1;
+	setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, (const char*)&nodelay, sizeof(nodelay));
+}
+
+Socket openListener(int port) {
+	//loopback only, this is a test harness and not meant to face a network
+	Socket listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (listener == INVALID_SOCKET) {
+		return INVALID_SOCKET;
+	}
+	int reuse = 1;
+	setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, (const char*)&reuse, sizeof(reuse));
+	sockaddr_in address;
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_port = htons((unsigned short)port);
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	if (bind(listener, (sockaddr*)&address, sizeof(address)) != 0 || listen(listener, SERVER_BACKLOG) != 0) {
+		closeSocket(listener);
+		return INVALID_SOCKET;
+	}
+	setNonBlocking(listener);
+	return listener;
+}
+
+Socket connectLocal(int port) {
+	Socket connection = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (connection == INVALID_SOCKET) {
+		return INVALID_SOCKET;
+	}
+	sockaddr_in address;
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_port = htons((unsigned short)port);
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	if (connect(connection, (sockaddr*)&address, sizeof(address)) != 0) {
+		closeSocket(connection);
+		return INVALID_SOCKET;
+	}
+	return connection;
+}
+
+
+
+//-------------------
+//------SESSIONS-----
+//-------------------
+
+int byteToAction(char key) {
+	//the same letters the game reads from the keyboard, lowercase only
+	const char* found = key != '\0' ? strchr(SERVER_KEYS + 1, key) : NULL;
+	return found != NULL ? (int)(found - SERVER_KEYS) : INPUT_NONE;
+}
+
+char actionToByte(int action) {
+	return action > INPUT_NONE && action < INPUT_ACTIONS ? SERVER_KEYS[action] : '\0';
+}
+
+void resetSession(Server* server, int index) {
+	//a fresh game, seeded like a batch game so a session can be replayed on its own
+	Session* session = &server->sessions[index];
+	session->state = *server->base;
+	initCarTable(&session->cars, session->state.car_count);
+	seedBatchGame(&session->state, server->seed, index);
+	session->queue = InputQueue();
+	session->frame.clear();
+	session->out.clear();
+}
+
+void renderSession(Session* session) {
+	//the frame the game would draw, as plain text: map rows, then cars and the frog on top
+	GameState* state = &session->state;
+	int width = state->width;
+	int line = width + 1;
+	std::string* frame = &session->frame;
+	frame->assign((size_t)line * state->height + 1, ' ');
+	for (int y = 0; y < state->height; y++) {
+		for (int x = 0; x < width; x++) {
+			char cell = state->map[y * width + x];
+			(*frame)[y * line + x] = cell != '\0' ? cell : ' ';
+		}
+		(*frame)[y * line + width] = '\n';
+	}
+	for (int i = 0; i < session->cars.count; i++) {
+		int x = (int)floorf(session->cars.x[i]);
+		if (x >= 0 && x < width) {
+			(*frame)[session->cars.y[i] * line + x] = session->cars.symbol[i];
+		}
+	}
+	(*frame)[state->frog_y * line + state->frog_x] = state->frog_symbol;
+	//info on the top border, cut to the board
+	char info[SERVER_INFO_SIZE];
+	int length = snprintf(info, sizeof(info), "Time: [%.2f]s Points: [%d] HS: [%d]", state->timer, state->points, state->highscore);
+	for (int x = 0; x < length && x < width - 2; x++) {
+		(*frame)[1 + x] = info[x];
+	}
+	(*frame)[frame->size() - 1] = SERVER_FRAME_END;
+}
+
+void sessionTask(void* context, long long index, int) {
+	Server* server = (Server*)context;
+	Session* session = &server->sessions[index];
+	for (size_t k = 0; k < server->tick_accumulators.size() && session->state.quit; k++) {
+		//the clock as it stood right after this tick was consumed, so every key
+		//lands in the tick it was read before, as in the game
+		SimClock tick = server->clock;
+		tick.accumulator = server->tick_accumulators[k];
+		InputEvent inputs[INPUT_QUEUE_SIZE];
+		double start = clockNow();
+		int count = takeTickInputs(&session->queue, &tick, &session->state, inputs);
+		stepGame(&session->state, &session->cars, inputs, count);
+		recordPhase(&session->profiler, PHASE_SIMULATE, clockNow() - start);
+	}
+	if (server->render && session->socket != INVALID_SOCKET) {
+		double start = clockNow();
+		renderSession(session);
+		recordPhase(&session->profiler, PHASE_BUILD_FRAME, clockNow() - start);
+	}
+}
+
+
+
+//-------------------
+//------NETWORK------
+//-------------------
+
+void acceptPlayers(Server* server) {
+	//every connection gets the first session nobody plays, with a new game
+	Socket connection;
+	while ((connection = accept(server->listener, NULL, NULL)) != INVALID_SOCKET) {
+		int index = 0;
+		while (index < (int)server->sessions.size() && server->sessions[index].socket != INVALID_SOCKET) {
+			index++;
+		}
+		if (index == (int)server->sessions.size()) {
+			closeSocket(connection);
+			server->rejected++;
+			continue;
+		}
+		setNonBlocking(connection);
+		resetSession(server, index);
+		server->sessions[index].socket = connection;
+		server->sessions[index].players++;
+	}
+}
+
+int readKeys(Session* session) {
+	//every byte is a key press, 0 - the player is gone
+	char buffer[SERVER_READ_SIZE];
+	int received;
+	while ((received = recv(session->socket, buffer, sizeof(buffer), 0)) > 0) {
+		double now = clockNow();
+		for (int i = 0; i < received; i++) {
+			int action = byteToAction(buffer[i]);
+			if (action != INPUT_NONE) {
+				pushInput(&session->queue, action, now);
+			}
+		}
+	}
+	return received < 0 && wouldBlock();
+}
+
+int flushFrame(Session* session) {
+	//send what the socket takes now, the rest goes out when it has room, 0 - the player is gone
+	if (session->out.empty()) {
+		return true;
+	}
+	while (!session->out.empty()) {
+		int sent = send(session->socket, session->out.data(), (int)session->out.size(), MSG_NOSIGNAL);
+		if (sent < 0) {
+			return wouldBlock();
+		}
+		session->out.erase(0, sent);
+	}
+	//the frame is out, every key applied before it was rendered is now on the player's screen
+	double latency = takeInputLatency(&session->queue, clockNow());
+	if (latency >= 0.0) {
+		recordPhase(&session->profiler, PHASE_INPUT_LATENCY, latency);
+	}
+	session->frames_sent++;
+	return true;
+}
+
+void dropPlayer(Server* server, int index) {
+	Session* session = &server->sessions[index];
+	closeSocket(session->socket);
+	session->socket = INVALID_SOCKET;
+	session->out.clear();
+}
+
+void pollServer(Server* server, int timeout_ms) {
+	//wait for keys, new players or room to send until the next tick is due
+	int count = (int)server->sessions.size();
+	std::vector<pollfd> fds(count + 1);
+	fds[0].fd = server->listener;
+	fds[0].events = POLLIN;
+	for (int i = 0; i < count; i++) {
+		Session* session = &server->sessions[i];
+		fds[i + 1].fd = session->socket;
+		fds[i + 1].events = session->socket == INVALID_SOCKET ? 0 : session->out.empty() ? POLLIN : POLLIN | POLLOUT;
+		fds[i + 1].revents = 0;
+	}
+	//a socket that is not open is skipped by poll
+	if (poll(fds.data(), (unsigned long)fds.size(), timeout_ms) <= 0) {
+		return;
+	}
+	for (int i = 0; i < count; i++) {
+		Session* session = &server->sessions[i];
+		short events = fds[i + 1].revents;
+		if (session->socket == INVALID_SOCKET || events == 0) {
+			continue;
+		}
+		if (((events & (POLLIN | POLLHUP | POLLERR)) && !readKeys(session)) || ((events & POLLOUT) && !flushFrame(session))) {
+			dropPlayer(server, i);
+		}
+	}
+	if (fds[0].revents & POLLIN) {
+		acceptPlayers(server);
+	}
+}
+
+
+
+//-------------------
+//------PLAYERS------
+//-------------------
+
+void playerLoop(Server* server, int index) {
+	//stands in for a remote terminal: reads frames and now and then presses a key,
+	//timing each key until the next whole frame arrives
+	Socket connection = connectLocal(server->port);
+	if (connection == INVALID_SOCKET) {
+		return;
+	}
+	Rng rng;
+	seedRng(&rng, (server->seed << 32) + 2 * (uint64_t)index + 1);
+	char buffer[SERVER_READ_SIZE];
+	double pressed = -1.0;
+	while (!server->stop.load()) {
+		pollfd fd;
+		fd.fd = connection;
+		fd.events = POLLIN;
+		fd.revents = 0;
+		if (poll(&fd, 1, PLAYER_POLL_MS) <= 0) {
+			continue;
+		}
+		int received = recv(connection, buffer, sizeof(buffer), 0);
+		if (received <= 0) {
+			break;
+		}
+		for (int i = 0; i < received; i++) {
+			if (buffer[i] != SERVER_FRAME_END) {
+				continue;
+			}
+			double now = clockNow();
+			if (pressed >= 0.0) {
+				recordPhase(&server->players, PHASE_INPUT_LATENCY, now - pressed);
+				pressed = -1.0;
+			}
+			InputEvent input;
+			randomInput(&input, &rng);
+			char key = actionToByte(input.action);
+			if (key != '\0' && send(connection, &key, 1, MSG_NOSIGNAL) == 1) {
+				pressed = now;
+			}
+		}
+	}
+	closeSocket(connection);
+}
+
+
+
+//-------------------
+//------REPORT-------
+//-------------------
+
+void mergePhase(PhaseHistogram* into, const PhaseHistogram* from) {
+	for (int i = 0; i < PROFILE_BUCKETS; i++) {
+		into->buckets[i] += from->buckets[i].load();
+	}
+	into->count += from->count.load();
+	into->total_us += from->total_us.load();
+	if (from->max_us.load() > into->max_us.load()) {
+		into->max_us = from->max_us.load();
+	}
+}
+
+void printPhase(const char* name, const PhaseHistogram* histogram) {
+	printf("%-13s%8.0f %8.0f %8llu\n", name, phasePercentile(histogram, 50.0), phasePercentile(histogram, 99.0),
+		(unsigned long long)histogram->max_us.load());
+}
+
+void printServerStats(Server* server, int threads, int players, double seconds) {
+	long long session_ticks = 0;
+	long long frames = 0;
+	long long dropped = 0;
+	Profiler total;
+	initProfiler(&total);
+	for (size_t i = 0; i < server->sessions.size(); i++) {
+		Session* session = &server->sessions[i];
+		for (int phase = 0; phase < PHASE_COUNT; phase++) {
+			mergePhase(&total.phases[phase], &session->profiler.phases[phase]);
+		}
+		session_ticks += (long long)session->profiler.phases[PHASE_SIMULATE].count.load();
+		frames += session->frames_sent;
+		dropped += session->frames_dropped;
+	}
+	printf("sessions:    %d, %d stand-in players, %lld turned away\n", (int)server->sessions.size(), players, server->rejected);
+	printf("threads:     %d\n", threads);
+	printf("seconds:     %.3f\n", seconds);
+	printf("ticks:       %lld, %lld dropped by the clock\n", server->clock.ticks, server->clock.dropped_ticks);
+	printf("ticks/s:     %.0f over all sessions\n", seconds > 0.0 ? session_ticks / seconds : 0.0);
+	printf("frames:      %lld sent, %lld dropped for slow players\n", frames, dropped);
+	printf("\n%-13s%8s %8s %8s   (us)\n", "", "p50", "p99", "max");
+	printPhase("pass", &server->profiler.phases[PHASE_SIMULATE]);
+	printPhase("tick", &total.phases[PHASE_SIMULATE]);
+	printPhase("frame", &total.phases[PHASE_BUILD_FRAME]);
+	printPhase("key->frame", &total.phases[PHASE_INPUT_LATENCY]);
+	printPhase("round trip", &server->players.phases[PHASE_INPUT_LATENCY]);
+	printf("\n%-8s%8s %8s %10s %10s\n", "session", "players", "frames", "key p50", "key p99");
+	for (size_t i = 0; i < server->sessions.size() && i < SERVER_REPORT_ROWS; i++) {
+		Session* session = &server->sessions[i];
+		const PhaseHistogram* latency = &session->profiler.phases[PHASE_INPUT_LATENCY];
+		printf("%-8d%8lld %8lld %10.0f %10.0f\n", (int)i, session->players, session->frames_sent,
+			phasePercentile(latency, 50.0), phasePercentile(latency, 99.0));
+	}
+}
+
+void runServer(HeadlessOptions* options, const GameState* base) {
+	Server server;
+	int threads = options->threads > 0 ? options->threads : defaultThreadCount();
+	if (!initSockets()) {
+		fprintf(stderr, "cannot start sockets\n");
+		return;
+	}
+	server.base = base;
+	server.seed = options->seed;
+	server.port = options->port;
+	server.listener = openListener(options->port);
+	if (server.listener == INVALID_SOCKET) {
+		fprintf(stderr, "cannot listen on port %d\n", options->port);
+		return;
+	}
+	server.sessions = std::vector<Session>(options->sessions);
+	for (int i = 0; i < options->sessions; i++) {
+		initProfiler(&server.sessions[i].profiler);
+		resetSession(&server, i);
+	}
+	initProfiler(&server.profiler);
+	initProfiler(&server.players);
+	printf("listening:   127.0.0.1:%d, keys %s\n", options->port, SERVER_KEYS + 1);
+	fflush(stdout);
+	std::vector<std::thread> players;
+	for (int i = 0; i < options->players; i++) {
+		players.push_back(std::thread(playerLoop, &server, i));
+	}
+
+	double tick_rate = base->tick_rate > 0 ? base->tick_rate : DEFAULT_TICK_RATE;
+	initClock(&server.clock, tick_rate, base->render_rate, base->max_catch_up);
+	startWorkerPool(&server.workers, threads, sessionTask, &server);
+	double start = clockNow();
+	while (server.clock.ticks < options->ticks) {
+		pollServer(&server, msUntilNextEvent(&server.clock));
+		advanceClock(&server.clock);
+		server.tick_accumulators.clear();
+		while (server.clock.ticks < options->ticks && consumeTick(&server.clock)) {
+			server.tick_accumulators.push_back(server.clock.accumulator);
+		}
+		server.render = shouldRender(&server.clock);
+		if (server.tick_accumulators.empty() && !server.render) {
+			continue;
+		}
+		double pass = clockNow();
+		runPass(&server.workers, (long long)server.sessions.size());
+		recordPhase(&server.profiler, PHASE_SIMULATE, clockNow() - pass);
+		//hand out the frames, a quit ends the player's connection and frees the session
+		for (int i = 0; i < (int)server.sessions.size(); i++) {
+			Session* session = &server.sessions[i];
+			if (session->socket == INVALID_SOCKET) {
+				if (!session->state.quit) {
+					resetSession(&server, i);
+				}
+				continue;
+			}
+			if (!session->frame.empty()) {
+				if (session->out.empty()) {
+					session->out.swap(session->frame);
+				}
+				else {
+					session->frames_dropped++;
+				}
+				session->frame.clear();
+			}
+			if (!flushFrame(session) || !session->state.quit) {
+				dropPlayer(&server, i);
+			}
+		}
+	}
+	double seconds = clockNow() - start;
+	stopWorkerPool(&server.workers);
+
+	server.stop = true;
+	for (int i = 0; i < (int)server.sessions.size(); i++) {
+		if (server.sessions[i].socket != INVALID_SOCKET) {
+			dropPlayer(&server, i);
+		}
+	}
+	for (size_t i = 0; i < players.size(); i++) {
+		players[i].join();
+	}
+	closeSocket(server.listener);
+	printServerStats(&server, threads, options->players, seconds);
+}